@@ -101,4 +101,24 @@ private:
    bool mOwned;
 };
 
+/**
+ * Holds the GIL for the current thread while in scope.
+ * This may be used on any thread, including one which already holds the GIL.
+ */
+class GilLock
+{
+public:
+   GilLock() : mState(PyGILState_Ensure()) {}
+   ~GilLock()
+   {
+      PyGILState_Release(mState);
+   }
+
+private:
+   GilLock(const GilLock& rhs);
+   GilLock& operator=(const GilLock& rhs);
+
+   PyGILState_STATE mState;
+};
+
 #endif
@@ -13,16 +13,59 @@
 #include "ConfigurationSettings.h"
 #include "Interpreter.h"
 
+class DynamicObject;
+class PlugInArgList;
+
 class PythonInterpreter : public Interpreter
 {
 public:
    SETTING_PTR(UserFile, PythonEngine, Filename);
    SETTING(InteractiveAvailable, PythonEngine, bool, true);
    SETTING(PythonHome, PythonEngine, std::string, "");
+   SETTING(PrewarmEngine, PythonEngine, bool, false);
+   SETTING(BackgroundExecution, PythonEngine, bool, false);
+   SETTING(ScopedCodeCacheSize, PythonEngine, unsigned int, 64);
 
    virtual bool isPythonRunning() const = 0;
+
+   /**
+    * Initialize Python on the calling thread without importing the interactive interpreter or
+    * running the user file. The engine must be started and destroyed on this thread.
+    */
+   virtual bool initializePython() = 0;
+
+   /**
+    * Import the interactive interpreter, initializing Python first if needed.
+    * After initializePython() this may be called from a worker thread.
+    */
+   virtual bool importInterpreter() = 0;
+
+   /**
+    * Run the user file, importing the interactive interpreter first if needed.
+    * After initializePython() this may be called from a worker thread. A user file run that way
+    * must not use the GUI and can not install Python signal handlers, which only work on the
+    * thread that initialized Python. Its output is added to the startup message.
+    */
+   virtual bool runUserFile() = 0;
+
+   /**
+    * Finish starting the engine on the thread that initialized Python, running the user file first
+    * if it has not been run.
+    */
    virtual bool startPython() = 0;
    virtual std::string getStartupMessage() const = 0;
+
+   /**
+    * Run a script file as a scoped command.
+    *
+    * The script is compiled through the engine's script cache. Its globals are a copy of
+    * the interpreter's globals plus __file__, inputs and outputs, which wrap the argument
+    * lists as opticks.PlugInArgList objects, and results, which wraps pResults as an
+    * opticks.DynamicObject or is None.
+    */
+   virtual bool executeScript(const std::string& filename, PlugInArgList* pInArgList,
+      PlugInArgList* pOutArgList, DynamicObject* pResults, const Slot& output,
+      const Slot& error, Progress* pProgress) = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AbortMonitor.h"
+#include "Progress.h"
+#include "PythonCommon.h"
+#include "Slot.h"
+
+#include <QtCore/QMutexLocker>
+
+AbortMonitor::AbortMonitor(Progress* pProgress, long threadId) :
+   mpProgress(pProgress),
+   mThreadId(threadId),
+   mStop(false),
+   mAbortRequested(false),
+   mAborted(false)
+{
+   mpProgress->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &AbortMonitor::progressUpdated));
+}
+
+AbortMonitor::~AbortMonitor()
+{
+   mpProgress->detach(SIGNAL_NAME(Subject, Modified), Slot(this, &AbortMonitor::progressUpdated));
+   mMutex.lock();
+   mStop = true;
+   mCondition.wakeAll();
+   mMutex.unlock();
+   wait();
+   if (mAborted)
+   {
+      GilLock lock;
+      PyThreadState_SetAsyncExc(mThreadId, NULL);
+   }
+}
+
+bool AbortMonitor::wasAborted() const
+{
+   return mAborted;
+}
+
+void AbortMonitor::progressUpdated(Subject& subject, const std::string& signal, const boost::any& data)
+{
+   // called on the thread which updated the Progress, so reading it back does not race with the update
+   std::string text;
+   int percent = 0;
+   ReportingLevel level = NORMAL;
+   mpProgress->getProgress(text, percent, level);
+   if (level == ABORT)
+   {
+      QMutexLocker lock(&mMutex);
+      mAbortRequested = true;
+      mCondition.wakeAll();
+   }
+}
+
+void AbortMonitor::run()
+{
+   {
+      QMutexLocker lock(&mMutex);
+      while (!mAbortRequested && !mStop)
+      {
+         mCondition.wait(&mMutex);
+      }
+      if (mStop)
+      {
+         return;
+      }
+   }
+
+   // the GIL is only needed to raise the exception
+   GilLock gil;
+   PyThreadState_SetAsyncExc(mThreadId, PyExc_KeyboardInterrupt);
+   mAborted = true;
+}
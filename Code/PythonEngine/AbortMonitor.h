@@ -0,0 +1,74 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef ABORTMONITOR_H
+#define ABORTMONITOR_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <boost/any.hpp>
+#include <string>
+
+class Progress;
+class Subject;
+
+/**
+ * Watches a Progress for an abort request while a Python command runs.
+ *
+ * The monitor is told when the Progress is updated and its thread sleeps until an update has the
+ * ABORT reporting level, normally because the user pressed Cancel in the progress dialog. The thread
+ * then takes the GIL and raises KeyboardInterrupt asynchronously in the thread running the command.
+ * The interpreter delivers it between bytecodes, so tight loops pay nothing for the check.
+ *
+ * The Cancel button is only handled while the progress dialog processes events when progress is
+ * reported, with or without background execution. A command which never reports progress through
+ * opticks.progress can not be aborted this way.
+ */
+class AbortMonitor : public QThread
+{
+public:
+   /**
+    * Create a monitor. start() must be called to begin monitoring.
+    *
+    * @param pProgress
+    *        The Progress which reports an abort request with the ABORT reporting level.
+    * @param threadId
+    *        The Python thread id of the thread running the command.
+    */
+   AbortMonitor(Progress* pProgress, long threadId);
+
+   /**
+    * Stop monitoring. The GIL must not be held by the caller.
+    * Any KeyboardInterrupt which was raised but not yet delivered is cancelled.
+    */
+   virtual ~AbortMonitor();
+
+   bool wasAborted() const;
+
+   void progressUpdated(Subject& subject, const std::string& signal, const boost::any& data);
+
+protected:
+   virtual void run();
+
+private:
+   AbortMonitor(const AbortMonitor& rhs);
+   AbortMonitor& operator=(const AbortMonitor& rhs);
+
+   Progress* mpProgress;
+   long mThreadId;
+   QMutex mMutex;
+   QWaitCondition mCondition;
+   bool mStop;
+   bool mAbortRequested;
+   bool mAborted;
+};
+
+#endif
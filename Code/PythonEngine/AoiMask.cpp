@@ -0,0 +1,197 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AoiElement.h"
+#include "AoiMask.h"
+#include "BitMask.h"
+#include "ObjectResource.h"
+#include "TypesFile.h"
+
+#include <string.h>
+
+namespace
+{
+   Py_ssize_t rowBytes(int columns, bool packed)
+   {
+      return packed ? (columns + 7) / 8 : columns;
+   }
+
+   bool isSet(const unsigned char* pRow, int column, bool packed)
+   {
+      return packed ? (pRow[column / 8] & (0x80 >> (column % 8))) != 0 : pRow[column] != 0;
+   }
+}
+
+namespace AoiMask
+{
+   AoiElement* toAoiElement(PyObject* pHandle)
+   {
+      void* pAddress = PyLong_AsVoidPtr(pHandle);
+      if (pAddress == NULL)
+      {
+         if (!PyErr_Occurred())
+         {
+            PyErr_SetString(PyExc_ValueError, "Invalid AOI handle.");
+         }
+         return NULL;
+      }
+      AoiElement* pAoi = dynamic_cast<AoiElement*>(reinterpret_cast<DataElement*>(pAddress));
+      if (pAoi == NULL)
+      {
+         PyErr_SetString(PyExc_TypeError, "Handle is not an AOI element.");
+      }
+      return pAoi;
+   }
+
+   PyObject* aoi_to_mask(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      int minColumn = 0;
+      int minRow = 0;
+      int maxColumn = 0;
+      int maxRow = 0;
+      int packed = 0;
+      if (!PyArg_ParseTuple(pArgs, "Oiiiii", &pHandle, &minColumn, &minRow, &maxColumn, &maxRow, &packed))
+      {
+         return NULL;
+      }
+      AoiElement* pAoi = toAoiElement(pHandle);
+      if (pAoi == NULL)
+      {
+         return NULL;
+      }
+      if (maxColumn < minColumn || maxRow < minRow)
+      {
+         PyErr_SetString(PyExc_ValueError, "Invalid bounding box.");
+         return NULL;
+      }
+      const BitMask* pMask = pAoi->getSelectedPoints();
+      if (pMask == NULL)
+      {
+         PyErr_SetString(PyExc_RuntimeError, "The AOI has no selected points.");
+         return NULL;
+      }
+
+      const int columns = maxColumn - minColumn + 1;
+      const Py_ssize_t stride = rowBytes(columns, packed != 0);
+      PyObject* pResult = PyString_FromStringAndSize(NULL, stride * (maxRow - minRow + 1));
+      if (pResult == NULL)
+      {
+         return NULL;
+      }
+      unsigned char* pData = reinterpret_cast<unsigned char*>(PyString_AS_STRING(pResult));
+      memset(pData, 0, PyString_GET_SIZE(pResult));
+      Py_BEGIN_ALLOW_THREADS
+      for (int row = minRow; row <= maxRow; ++row)
+      {
+         unsigned char* pRow = pData + (row - minRow) * stride;
+         for (int column = 0; column < columns; ++column)
+         {
+            if (!pMask->getPixel(minColumn + column, row))
+            {
+               continue;
+            }
+            if (packed)
+            {
+               pRow[column / 8] |= static_cast<unsigned char>(0x80 >> (column % 8));
+            }
+            else
+            {
+               pRow[column] = 1;
+            }
+         }
+      }
+      Py_END_ALLOW_THREADS
+      return pResult;
+   }
+
+   PyObject* aoi_set_mask(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      int minColumn = 0;
+      int minRow = 0;
+      int rows = 0;
+      int columns = 0;
+      PyObject* pData = NULL;
+      int packed = 0;
+      if (!PyArg_ParseTuple(pArgs, "OiiiiOi", &pHandle, &minColumn, &minRow, &rows, &columns, &pData, &packed))
+      {
+         return NULL;
+      }
+      AoiElement* pAoi = toAoiElement(pHandle);
+      if (pAoi == NULL)
+      {
+         return NULL;
+      }
+      if (rows < 0 || columns < 0 || minColumn < 0 || minRow < 0)
+      {
+         PyErr_SetString(PyExc_ValueError, "Invalid mask location.");
+         return NULL;
+      }
+      const void* pBuffer = NULL;
+      Py_ssize_t length = 0;
+      if (PyObject_AsReadBuffer(pData, &pBuffer, &length) != 0)
+      {
+         return NULL;
+      }
+      const Py_ssize_t stride = rowBytes(columns, packed != 0);
+      if (length != stride * rows)
+      {
+         PyErr_Format(PyExc_ValueError, "Mask has %d bytes, but must have %d bytes",
+            static_cast<int>(length), static_cast<int>(stride * rows));
+         return NULL;
+      }
+
+      FactoryResource<BitMask> pSelect;
+      FactoryResource<BitMask> pDeselect;
+      const unsigned char* pMask = reinterpret_cast<const unsigned char*>(pBuffer);
+      bool anySelected = false;
+      bool anyDeselected = false;
+      // the masks are local until they are applied, so they are built without the GIL
+      Py_BEGIN_ALLOW_THREADS
+      // each run of pixels with the same state is set as one region instead of pixel by pixel
+      for (int row = 0; row < rows; ++row)
+      {
+         const unsigned char* pRow = pMask + row * stride;
+         int start = 0;
+         while (start < columns)
+         {
+            const bool selected = isSet(pRow, start, packed != 0);
+            int end = start + 1;
+            while (end < columns && isSet(pRow, end, packed != 0) == selected)
+            {
+               ++end;
+            }
+            if (selected)
+            {
+               pSelect->setRegion(minColumn + start, minRow + row, minColumn + end - 1, minRow + row, DRAW);
+               anySelected = true;
+            }
+            else
+            {
+               pDeselect->setRegion(minColumn + start, minRow + row, minColumn + end - 1, minRow + row, DRAW);
+               anyDeselected = true;
+            }
+            start = end;
+         }
+      }
+      Py_END_ALLOW_THREADS
+
+      // the element notifies its observers, so it is changed with the GIL held like any other API call
+      if (anyDeselected)
+      {
+         pAoi->removePoints(pDeselect.get());
+      }
+      if (anySelected)
+      {
+         pAoi->addPoints(pSelect.get());
+      }
+      Py_RETURN_NONE;
+   }
+}
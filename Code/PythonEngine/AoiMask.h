@@ -0,0 +1,51 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef AOIMASK_H
+#define AOIMASK_H
+
+#include "PythonCommon.h"
+
+class AoiElement;
+
+/**
+ * Bulk transfer of AOI selections to and from Python.
+ *
+ * Masks are row major with one byte per pixel or, when packed, with each row padded to a whole
+ * number of bytes and the first pixel in the most significant bit, matching numpy.packbits().
+ */
+namespace AoiMask
+{
+   /**
+    * Convert an opaque element handle, as stored in opticks.DataElement.handle, to an AoiElement.
+    *
+    * @param pHandle
+    *        An integer containing the address of the element.
+    *
+    * @return The AoiElement or NULL if a Python exception has been set.
+    */
+   AoiElement* toAoiElement(PyObject* pHandle);
+
+   /**
+    * aoi_to_mask(handle, min_column, min_row, max_column, max_row, packed) -> str
+    *
+    * Extract the selection state of an inclusive pixel region.
+    */
+   PyObject* aoi_to_mask(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * aoi_set_mask(handle, column, row, rows, columns, mask, packed)
+    *
+    * Select the pixels which are set in the mask and deselect those which are clear.
+    * Pixels outside of the mask are not changed.
+    */
+   PyObject* aoi_set_mask(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
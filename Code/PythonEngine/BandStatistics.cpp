@@ -0,0 +1,1027 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AoiElement.h"
+#include "AoiMask.h"
+#include "BandStatistics.h"
+#include "BitMask.h"
+#include "RasterBuffer.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "Slot.h"
+#include "Subject.h"
+#include "TypesFile.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <new>
+
+using RasterBuffer::SubCube;
+using RasterBuffer::ROW_DIM;
+using RasterBuffer::COLUMN_DIM;
+using RasterBuffer::BAND_DIM;
+
+namespace BandStatistics
+{
+   Accumulator::Accumulator() :
+      mCount(0),
+      mMean(0.0),
+      mM2(0.0),
+      mMin(std::numeric_limits<double>::max()),
+      mMax(-std::numeric_limits<double>::max())
+   {
+   }
+
+   void Accumulator::add(double value)
+   {
+      ++mCount;
+      const double delta = value - mMean;
+      mMean += delta / mCount;
+      mM2 += delta * (value - mMean);
+      mMin = std::min(mMin, value);
+      mMax = std::max(mMax, value);
+   }
+
+   void Accumulator::merge(const Accumulator& other)
+   {
+      if (other.mCount == 0)
+      {
+         return;
+      }
+      const double count = static_cast<double>(mCount + other.mCount);
+      const double delta = other.mMean - mMean;
+      mMean += delta * other.mCount / count;
+      mM2 += other.mM2 + delta * delta * mCount * other.mCount / count;
+      mCount += other.mCount;
+      mMin = std::min(mMin, other.mMin);
+      mMax = std::max(mMax, other.mMax);
+   }
+
+   double Accumulator::variance() const
+   {
+      return mCount == 0 ? std::numeric_limits<double>::quiet_NaN() : mM2 / mCount;
+   }
+
+   Histogram::Histogram(unsigned int bins, double lower, double upper) :
+      mLower(lower),
+      mUpper(upper),
+      mScale(upper > lower ? bins / (upper - lower) : 0.0),
+      mCounts(bins, 0)
+   {
+   }
+
+   void Histogram::add(double value)
+   {
+      if (value < mLower || value > mUpper)
+      {
+         return;
+      }
+      // the upper edge of the last bin is inclusive
+      size_t bin = static_cast<size_t>((value - mLower) * mScale);
+      ++mCounts[std::min(bin, mCounts.size() - 1)];
+   }
+
+   void Histogram::merge(const Histogram& other)
+   {
+      for (size_t bin = 0; bin < mCounts.size(); ++bin)
+      {
+         mCounts[bin] += other.mCounts[bin];
+      }
+   }
+}
+
+namespace
+{
+   using BandStatistics::Accumulator;
+   using BandStatistics::Histogram;
+
+   // upper limit on the raster data read by a worker at one time
+   const size_t CHUNK_BYTES = 4 * 1024 * 1024;
+
+   /**
+    * Reduce a BIP chunk of pixels. Values are added to the accumulators if pAccumulators is not NULL
+    * and to the histograms if pHistograms is not NULL. Every pixel is selected if pMask is NULL.
+    */
+   template<typename T>
+   void reduceChunk(const T* pData, const char* pMask, size_t pixels, size_t bandCount,
+                    const std::vector<unsigned int>& bandOffsets, std::vector<Accumulator>* pAccumulators,
+                    std::vector<Histogram>* pHistograms)
+   {
+      for (size_t pixel = 0; pixel < pixels; ++pixel, pData += bandCount)
+      {
+         if (pMask != NULL && pMask[pixel] == 0)
+         {
+            continue;
+         }
+         for (size_t band = 0; band < bandOffsets.size(); ++band)
+         {
+            const double value = static_cast<double>(pData[bandOffsets[band]]);
+            if (value != value)
+            {
+               continue; // NaN
+            }
+            if (pAccumulators != NULL)
+            {
+               (*pAccumulators)[band].add(value);
+            }
+            if (pHistograms != NULL)
+            {
+               (*pHistograms)[band].add(value);
+            }
+         }
+      }
+   }
+
+   /**
+    * The reduction of a block of rows of the selected region and its results.
+    * Every pixel of the block is selected if the mask is NULL. Tasks are run by runTasks().
+    */
+   class ReduceTask
+   {
+   public:
+      ReduceTask(RasterElement* pRaster, const SubCube& region, const char* pMask,
+                 const std::vector<unsigned int>& bandOffsets) :
+         mpRaster(pRaster),
+         mRegion(region),
+         mpMask(pMask),
+         mpBandOffsets(&bandOffsets),
+         mAccumulators(bandOffsets.size()),
+         mAccumulate(true),
+         mSuccess(true)
+      {
+      }
+
+      /**
+       * Collect histograms instead of accumulating statistics the next time the task runs.
+       */
+      void setHistograms(const std::vector<Histogram>& histograms)
+      {
+         mHistograms = histograms;
+         mAccumulate = false;
+      }
+
+      /**
+       * Discard the results so the next run reduces the block again. The values are added to both
+       * the accumulators and the histograms, which may be empty.
+       */
+      void reset(const std::vector<Histogram>& histograms)
+      {
+         mAccumulators.assign(mpBandOffsets->size(), Accumulator());
+         mHistograms = histograms;
+         mAccumulate = true;
+      }
+
+      bool succeeded() const
+      {
+         return mSuccess;
+      }
+
+      const std::vector<Accumulator>& getAccumulators() const
+      {
+         return mAccumulators;
+      }
+
+      const std::vector<Histogram>& getHistograms() const
+      {
+         return mHistograms;
+      }
+
+      /**
+       * Reduce the block. This does not use any Python objects so it may be called without the GIL.
+       */
+      void run()
+      {
+         const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+         const size_t columns = mRegion.count(COLUMN_DIM);
+         const size_t bandCount = mRegion.count(BAND_DIM);
+         const size_t rowBytes = columns * bandCount * pDesc->getBytesPerElement();
+         const unsigned int chunkRows = static_cast<unsigned int>(std::max<size_t>(1, CHUNK_BYTES / rowBytes));
+         mSuccess = true;
+         char* pData = new (std::nothrow) char[chunkRows * rowBytes];
+         if (pData == NULL)
+         {
+            mSuccess = false;
+            return;
+         }
+         std::vector<Accumulator>* pAccumulators = mAccumulate ? &mAccumulators : NULL;
+         std::vector<Histogram>* pHistograms = mHistograms.empty() ? NULL : &mHistograms;
+
+         SubCube chunk = mRegion;
+         for (unsigned int row = mRegion.mStart[ROW_DIM]; row <= mRegion.mEnd[ROW_DIM]; row += chunkRows)
+         {
+            chunk.mStart[ROW_DIM] = row;
+            chunk.mEnd[ROW_DIM] = std::min(mRegion.mEnd[ROW_DIM], row + chunkRows - 1);
+            if (!RasterBuffer::readSubCube(mpRaster, chunk, BIP, pData))
+            {
+               mSuccess = false;
+               break;
+            }
+            const size_t pixels = chunk.count(ROW_DIM) * columns;
+            const char* pMask = (mpMask == NULL) ? NULL : mpMask + (row - mRegion.mStart[ROW_DIM]) * columns;
+            switch (pDesc->getDataType())
+            {
+            case INT1SBYTE:
+               reduceChunk(reinterpret_cast<signed char*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            case INT1UBYTE:
+               reduceChunk(reinterpret_cast<unsigned char*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            case INT2SBYTES:
+               reduceChunk(reinterpret_cast<signed short*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            case INT2UBYTES:
+               reduceChunk(reinterpret_cast<unsigned short*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            case INT4SBYTES:
+               reduceChunk(reinterpret_cast<signed int*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            case INT4UBYTES:
+               reduceChunk(reinterpret_cast<unsigned int*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            case FLT4BYTES:
+               reduceChunk(reinterpret_cast<float*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            case FLT8BYTES:
+               reduceChunk(reinterpret_cast<double*>(pData), pMask, pixels, bandCount, *mpBandOffsets,
+                  pAccumulators, pHistograms);
+               break;
+            default:
+               mSuccess = false;
+               break;
+            }
+         }
+         delete [] pData;
+      }
+
+   private:
+      RasterElement* mpRaster;
+      SubCube mRegion;
+      const char* mpMask;
+      const std::vector<unsigned int>* mpBandOffsets;
+      std::vector<Accumulator> mAccumulators;
+      std::vector<Histogram> mHistograms;
+      bool mAccumulate;
+      bool mSuccess;
+   };
+
+   /**
+    * A queue of tasks shared by the threads of runTasks().
+    */
+   class TaskQueue
+   {
+   public:
+      TaskQueue(ReduceTask* pTasks, size_t count) :
+         mpNext(pTasks),
+         mpEnd(pTasks + count)
+      {
+      }
+
+      /**
+       * @return The next task to run or NULL if every task has been taken.
+       */
+      ReduceTask* take()
+      {
+         QMutexLocker lock(&mMutex);
+         return mpNext == mpEnd ? NULL : mpNext++;
+      }
+
+   private:
+      TaskQueue(const TaskQueue& rhs);
+      TaskQueue& operator=(const TaskQueue& rhs);
+
+      QMutex mMutex;
+      ReduceTask* mpNext;
+      ReduceTask* const mpEnd;
+   };
+
+   class PoolThread : public QThread
+   {
+   public:
+      PoolThread(TaskQueue& queue) :
+         mQueue(queue)
+      {
+      }
+
+   protected:
+      virtual void run()
+      {
+         for (ReduceTask* pTask = mQueue.take(); pTask != NULL; pTask = mQueue.take())
+         {
+            pTask->run();
+         }
+      }
+
+   private:
+      PoolThread(const PoolThread& rhs);
+      PoolThread& operator=(const PoolThread& rhs);
+
+      TaskQueue& mQueue;
+   };
+
+   /**
+    * Run tasks to completion on a pool of at most one thread per processor which take tasks from a queue.
+    *
+    * @return False if any of the tasks failed.
+    */
+   bool runTasks(ReduceTask* pTasks, size_t count)
+   {
+      TaskQueue queue(pTasks, count);
+      const size_t threadCount = std::min(count, static_cast<size_t>(std::max(1, QThread::idealThreadCount())));
+      std::vector<PoolThread*> threads;
+      for (size_t thread = 0; thread < threadCount; ++thread)
+      {
+         threads.push_back(new PoolThread(queue));
+         threads.back()->start();
+      }
+      for (std::vector<PoolThread*>::iterator pThread = threads.begin(); pThread != threads.end(); ++pThread)
+      {
+         (*pThread)->wait();
+         delete *pThread;
+      }
+      bool success = true;
+      for (size_t task = 0; task < count; ++task)
+      {
+         success = success && pTasks[task].succeeded();
+      }
+      return success;
+   }
+
+   /**
+    * Reduce the selected pixels of a region of a raster element. The GIL should be released.
+    *
+    * @return False if the raster data could not be read.
+    */
+   bool reduceRegion(RasterElement* pRaster, const SubCube& region, const char* pMask,
+                     const std::vector<unsigned int>& bandOffsets, unsigned int bins,
+                     std::vector<Accumulator>& accumulators, std::vector<Histogram>& histograms)
+   {
+      const unsigned int rows = static_cast<unsigned int>(region.count(ROW_DIM));
+      const unsigned int threadCount = std::min(rows, static_cast<unsigned int>(std::max(1, QThread::idealThreadCount())));
+      const unsigned int rowsPerThread = (rows + threadCount - 1) / threadCount;
+      const size_t columns = region.count(COLUMN_DIM);
+
+      std::vector<ReduceTask> tasks;
+      for (unsigned int row = region.mStart[ROW_DIM]; row <= region.mEnd[ROW_DIM]; row += rowsPerThread)
+      {
+         SubCube block = region;
+         block.mStart[ROW_DIM] = row;
+         block.mEnd[ROW_DIM] = std::min(region.mEnd[ROW_DIM], row + rowsPerThread - 1);
+         tasks.push_back(ReduceTask(pRaster, block, pMask + (row - region.mStart[ROW_DIM]) * columns, bandOffsets));
+      }
+
+      bool success = runTasks(&tasks[0], tasks.size());
+      for (std::vector<ReduceTask>::const_iterator pTask = tasks.begin(); success && pTask != tasks.end(); ++pTask)
+      {
+         for (size_t band = 0; band < accumulators.size(); ++band)
+         {
+            accumulators[band].merge(pTask->getAccumulators()[band]);
+         }
+      }
+
+      // the histogram range is not known until the first pass is complete
+      if (success && bins > 0)
+      {
+         for (size_t band = 0; band < accumulators.size(); ++band)
+         {
+            histograms.push_back(Histogram(bins, accumulators[band].mMin, accumulators[band].mMax));
+         }
+         for (std::vector<ReduceTask>::iterator pTask = tasks.begin(); pTask != tasks.end(); ++pTask)
+         {
+            pTask->setHistograms(histograms);
+         }
+         success = runTasks(&tasks[0], tasks.size());
+         for (std::vector<ReduceTask>::const_iterator pTask = tasks.begin(); success && pTask != tasks.end(); ++pTask)
+         {
+            for (size_t band = 0; band < histograms.size(); ++band)
+            {
+               histograms[band].merge(pTask->getHistograms()[band]);
+            }
+         }
+      }
+      return success;
+   }
+
+   PyObject* histogramToPython(const Histogram& histogram)
+   {
+      PyObject* pCounts = PyList_New(histogram.mCounts.size());
+      if (pCounts == NULL)
+      {
+         return NULL;
+      }
+      for (size_t bin = 0; bin < histogram.mCounts.size(); ++bin)
+      {
+         PyObject* pCount = PyLong_FromUnsignedLongLong(histogram.mCounts[bin]);
+         if (pCount == NULL)
+         {
+            Py_DECREF(pCounts);
+            return NULL;
+         }
+         PyList_SET_ITEM(pCounts, bin, pCount);
+      }
+      return Py_BuildValue("(Ndd)", pCounts, histogram.mLower, histogram.mUpper);
+   }
+
+   /**
+    * Check that statistics can be calculated for a raster element's encoding.
+    *
+    * @return False if a Python exception has been set.
+    */
+   bool checkEncoding(const RasterDataDescriptor* pDesc)
+   {
+      const int encoding = pDesc->getDataType();
+      if (encoding < INT1SBYTE || encoding > FLT8BYTES || encoding == INT4SCOMPLEX || encoding == FLT8COMPLEX)
+      {
+         PyErr_SetString(PyExc_TypeError, "Statistics can't be calculated for the raster element's encoding.");
+         return false;
+      }
+      return true;
+   }
+
+   /**
+    * Convert a sequence of band indices.
+    *
+    * @return False if a Python exception has been set.
+    */
+   bool parseBands(PyObject* pBands, const RasterDataDescriptor* pDesc, std::vector<unsigned int>& bands)
+   {
+      auto_obj bandSeq(PySequence_Fast(pBands, "bands must be a sequence"), true);
+      if (bandSeq.get() == NULL)
+      {
+         return false;
+      }
+      for (Py_ssize_t idx = 0; idx < PySequence_Fast_GET_SIZE(bandSeq.get()); ++idx)
+      {
+         long band = PyInt_AsLong(PySequence_Fast_GET_ITEM(bandSeq.get(), idx));
+         if (band == -1 && PyErr_Occurred())
+         {
+            return false;
+         }
+         if (band < 0 || band >= static_cast<long>(pDesc->getBandCount()))
+         {
+            PyErr_SetString(PyExc_IndexError, "Band index is outside of the raster element.");
+            return false;
+         }
+         bands.push_back(static_cast<unsigned int>(band));
+      }
+      return true;
+   }
+
+   /**
+    * Statistics of every pixel of a raster element which are kept per strip of rows.
+    * The element may be destroyed on any thread. Its destruction waits for a running update,
+    * and later updates fail while the statistics already gathered remain available.
+    */
+   class StatisticsEngine
+   {
+   public:
+      /**
+       * @param bands
+       *        The band indices to reduce. This must not be empty.
+       * @param bins
+       *        The number of histogram bins or 0 if there are no histograms.
+       * @param lower
+       *        The lower edge of every histogram. If this is greater than upper, the range of
+       *        each band's histogram is its minimum to maximum after the first update.
+       * @param upper
+       *        The inclusive upper edge of every histogram.
+       * @param stripRows
+       *        The number of rows in each strip.
+       */
+      StatisticsEngine(RasterElement* pRaster, const std::vector<unsigned int>& bands, unsigned int bins,
+                       double lower, double upper, unsigned int stripRows) :
+         mRows(static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor())->getRowCount()),
+         mBins(bins),
+         mStripRows(std::max(1U, stripRows)),
+         mpRaster(pRaster),
+         mScanned(false),
+         mDeleted(0)
+      {
+         const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+         const unsigned int firstBand = *std::min_element(bands.begin(), bands.end());
+         for (std::vector<unsigned int>::const_iterator band = bands.begin(); band != bands.end(); ++band)
+         {
+            mBandOffsets.push_back(*band - firstBand);
+         }
+         if (bins > 0 && lower <= upper)
+         {
+            mHistograms.resize(bands.size(), Histogram(bins, lower, upper));
+         }
+
+         SubCube strip;
+         strip.mStart[COLUMN_DIM] = 0;
+         strip.mEnd[COLUMN_DIM] = pDesc->getColumnCount() - 1;
+         strip.mStart[BAND_DIM] = firstBand;
+         strip.mEnd[BAND_DIM] = *std::max_element(bands.begin(), bands.end());
+         strip.mStep[ROW_DIM] = 1;
+         strip.mStep[COLUMN_DIM] = 1;
+         strip.mStep[BAND_DIM] = 1;
+         for (unsigned int row = 0; row < mRows; row += mStripRows)
+         {
+            strip.mStart[ROW_DIM] = row;
+            strip.mEnd[ROW_DIM] = std::min(mRows - 1, row + mStripRows - 1);
+            mStrips.push_back(ReduceTask(pRaster, strip, NULL, mBandOffsets));
+         }
+         mpRaster->attach(SIGNAL_NAME(Subject, Deleted), Slot(this, &StatisticsEngine::elementDeleted));
+      }
+
+      ~StatisticsEngine()
+      {
+         if (mDeleted.fetchAndStoreOrdered(1) == 0)
+         {
+            mpRaster->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &StatisticsEngine::elementDeleted));
+         }
+      }
+
+      unsigned int getRows() const
+      {
+         return mRows;
+      }
+
+      bool isDeleted() const
+      {
+         return mDeleted != 0;
+      }
+
+      void elementDeleted(Subject& subject, const std::string& signal, const boost::any& data)
+      {
+         // the element is still valid during the notification, so a running update is allowed to finish
+         QMutexLocker lock(&mMutex);
+         mDeleted.fetchAndStoreOrdered(1);
+      }
+
+      /**
+       * Reduce the strips which contain rows from rowStart to rowEnd again, or every strip if
+       * this is the first successful update. This does not use any Python objects so the GIL
+       * should be released.
+       *
+       * @return False if the raster data could not be read or the raster element has been destroyed.
+       */
+      bool update(unsigned int rowStart, unsigned int rowEnd)
+      {
+         QMutexLocker lock(&mMutex);
+         if (isDeleted())
+         {
+            return false;
+         }
+         if (!mScanned)
+         {
+            rowStart = 0;
+            rowEnd = mRows - 1;
+         }
+         rowEnd = std::min(rowEnd, mRows - 1);
+         if (rowStart > rowEnd)
+         {
+            return true;
+         }
+         ReduceTask* const pStrips = &mStrips[rowStart / mStripRows];
+         const size_t stripCount = rowEnd / mStripRows - rowStart / mStripRows + 1;
+
+         // the histogram ranges are not known until the statistics of every strip are
+         const bool findRanges = mBins > 0 && mHistograms.empty();
+         for (size_t strip = 0; strip < stripCount; ++strip)
+         {
+            pStrips[strip].reset(mHistograms);
+         }
+         if (!runTasks(pStrips, stripCount))
+         {
+            return false;
+         }
+         if (findRanges)
+         {
+            std::vector<Accumulator> accumulators;
+            std::vector<Histogram> histograms;
+            mergeStrips(accumulators, histograms);
+            for (std::vector<Accumulator>::const_iterator pBand = accumulators.begin();
+               pBand != accumulators.end(); ++pBand)
+            {
+               mHistograms.push_back(pBand->mCount == 0 ? Histogram(mBins) :
+                  Histogram(mBins, pBand->mMin, pBand->mMax));
+            }
+            for (size_t strip = 0; strip < stripCount; ++strip)
+            {
+               pStrips[strip].setHistograms(mHistograms);
+            }
+            if (!runTasks(pStrips, stripCount))
+            {
+               mHistograms.clear();
+               return false;
+            }
+         }
+         mScanned = true;
+         return true;
+      }
+
+      /**
+       * Merge the statistics of every strip. This does not use any Python objects so the GIL
+       * should be released.
+       */
+      void merge(std::vector<Accumulator>& accumulators, std::vector<Histogram>& histograms)
+      {
+         QMutexLocker lock(&mMutex);
+         mergeStrips(accumulators, histograms);
+      }
+
+   private:
+      StatisticsEngine(const StatisticsEngine& rhs);
+      StatisticsEngine& operator=(const StatisticsEngine& rhs);
+
+      void mergeStrips(std::vector<Accumulator>& accumulators, std::vector<Histogram>& histograms) const
+      {
+         accumulators.assign(mBandOffsets.size(), Accumulator());
+         histograms = mHistograms;
+         for (std::vector<ReduceTask>::const_iterator pStrip = mStrips.begin(); pStrip != mStrips.end(); ++pStrip)
+         {
+            const std::vector<Accumulator>& stripAccumulators = pStrip->getAccumulators();
+            const std::vector<Histogram>& stripHistograms = pStrip->getHistograms();
+            for (size_t band = 0; band < accumulators.size(); ++band)
+            {
+               accumulators[band].merge(stripAccumulators[band]);
+               if (!histograms.empty() && !stripHistograms.empty())
+               {
+                  histograms[band].merge(stripHistograms[band]);
+               }
+            }
+         }
+      }
+
+      const unsigned int mRows;
+      const unsigned int mBins;
+      const unsigned int mStripRows;
+      std::vector<unsigned int> mBandOffsets;
+      std::vector<Histogram> mHistograms;
+      std::vector<ReduceTask> mStrips;   // the statistics of each strip, which are run on a pool of threads
+      RasterElement* mpRaster;
+      bool mScanned;
+      QAtomicInt mDeleted;
+      QMutex mMutex;
+   };
+
+   struct StatisticsEngineObject
+   {
+      PyObject_HEAD
+      StatisticsEngine* mpEngine;
+   };
+
+   void statisticsEngineDealloc(StatisticsEngineObject* pSelf)
+   {
+      delete pSelf->mpEngine;
+      pSelf->ob_type->tp_free(reinterpret_cast<PyObject*>(pSelf));
+   }
+
+   PyObject* statisticsEngineUpdate(StatisticsEngineObject* pSelf, PyObject* pArgs)
+   {
+      const long rows = static_cast<long>(pSelf->mpEngine->getRows());
+      long rowStart = 0;
+      long rowEnd = rows - 1;
+      if (!PyArg_ParseTuple(pArgs, "|ll", &rowStart, &rowEnd))
+      {
+         return NULL;
+      }
+      if (rowStart < 0 || rowEnd < 0 || rowStart >= rows || rowEnd >= rows)
+      {
+         PyErr_SetString(PyExc_IndexError, "Row range is outside of the raster element.");
+         return NULL;
+      }
+      if (pSelf->mpEngine->isDeleted())
+      {
+         PyErr_SetString(PyExc_ValueError, "The raster element of these statistics has been destroyed.");
+         return NULL;
+      }
+      bool success = false;
+      Py_BEGIN_ALLOW_THREADS
+      success = pSelf->mpEngine->update(static_cast<unsigned int>(rowStart), static_cast<unsigned int>(rowEnd));
+      Py_END_ALLOW_THREADS
+      if (!success && pSelf->mpEngine->isDeleted())
+      {
+         PyErr_SetString(PyExc_ValueError, "The raster element of these statistics has been destroyed.");
+         return NULL;
+      }
+      if (!success)
+      {
+         PyErr_SetString(PyExc_RuntimeError, "Unable to access the raster element data.");
+         return NULL;
+      }
+      Py_RETURN_NONE;
+   }
+
+   template<typename T>
+   PyObject* itemsToString(const std::vector<T>& items)
+   {
+      return PyString_FromStringAndSize(items.empty() ? NULL : reinterpret_cast<const char*>(&items[0]),
+         items.size() * sizeof(T));
+   }
+
+   PyObject* statisticsEngineResult(StatisticsEngineObject* pSelf)
+   {
+      std::vector<Accumulator> accumulators;
+      std::vector<Histogram> histograms;
+      Py_BEGIN_ALLOW_THREADS
+      pSelf->mpEngine->merge(accumulators, histograms);
+      Py_END_ALLOW_THREADS
+
+      const double nan = std::numeric_limits<double>::quiet_NaN();
+      std::vector<unsigned long long> counts;
+      std::vector<double> means;
+      std::vector<double> stds;
+      std::vector<double> minimums;
+      std::vector<double> maximums;
+      for (std::vector<Accumulator>::const_iterator pBand = accumulators.begin(); pBand != accumulators.end(); ++pBand)
+      {
+         counts.push_back(pBand->mCount);
+         means.push_back(pBand->mCount == 0 ? nan : pBand->mMean);
+         stds.push_back(sqrt(pBand->variance()));
+         minimums.push_back(pBand->mCount == 0 ? nan : pBand->mMin);
+         maximums.push_back(pBand->mCount == 0 ? nan : pBand->mMax);
+      }
+      std::vector<unsigned long long> binCounts;
+      std::vector<double> lowers;
+      std::vector<double> uppers;
+      for (std::vector<Histogram>::const_iterator pBand = histograms.begin(); pBand != histograms.end(); ++pBand)
+      {
+         binCounts.insert(binCounts.end(), pBand->mCounts.begin(), pBand->mCounts.end());
+         lowers.push_back(pBand->mLower);
+         uppers.push_back(pBand->mUpper);
+      }
+
+      auto_obj pCounts(itemsToString(counts), true);
+      auto_obj pMeans(itemsToString(means), true);
+      auto_obj pStds(itemsToString(stds), true);
+      auto_obj pMinimums(itemsToString(minimums), true);
+      auto_obj pMaximums(itemsToString(maximums), true);
+      auto_obj pHistograms(histograms.empty() ? Py_None : itemsToString(binCounts), !histograms.empty());
+      auto_obj pLowers(itemsToString(lowers), true);
+      auto_obj pUppers(itemsToString(uppers), true);
+      if (pCounts.get() == NULL || pMeans.get() == NULL || pStds.get() == NULL || pMinimums.get() == NULL ||
+         pMaximums.get() == NULL || pHistograms.get() == NULL || pLowers.get() == NULL || pUppers.get() == NULL)
+      {
+         return NULL;
+      }
+      return Py_BuildValue("(OOOOOOOO)", pCounts.get(), pMeans.get(), pStds.get(), pMinimums.get(),
+         pMaximums.get(), pHistograms.get(), pLowers.get(), pUppers.get());
+   }
+
+   PyMethodDef sStatisticsEngineMethods[] = {
+      {"update", reinterpret_cast<PyCFunction>(statisticsEngineUpdate), METH_VARARGS,
+         "update(row_start=0, row_end=rows-1)\nReduce the strips which contain the rows again."},
+      {"result", reinterpret_cast<PyCFunction>(statisticsEngineResult), METH_NOARGS,
+         "result() -> (counts, means, stds, minimums, maximums, histograms, lowers, uppers)\n" \
+         "Merge the statistics of every strip into strings of native uint64 and double items per band. " \
+         "histograms is None if there are no histograms, otherwise it holds the bin counts of each band in turn."},
+      {NULL, NULL, 0, NULL} // sentinel
+   };
+
+   PyTypeObject sStatisticsEngineType = {
+      PyObject_HEAD_INIT(NULL)
+      0,                                                 // ob_size
+      "_opticks.StatisticsEngine",                       // tp_name
+      sizeof(StatisticsEngineObject),                    // tp_basicsize
+      0,                                                 // tp_itemsize
+      reinterpret_cast<destructor>(statisticsEngineDealloc), // tp_dealloc
+      0,                                                 // tp_print
+      0,                                                 // tp_getattr
+      0,                                                 // tp_setattr
+      0,                                                 // tp_compare
+      0,                                                 // tp_repr
+      0,                                                 // tp_as_number
+      0,                                                 // tp_as_sequence
+      0,                                                 // tp_as_mapping
+      0,                                                 // tp_hash
+      0,                                                 // tp_call
+      0,                                                 // tp_str
+      0,                                                 // tp_getattro
+      0,                                                 // tp_setattro
+      0,                                                 // tp_as_buffer
+      Py_TPFLAGS_DEFAULT,                                // tp_flags
+      "Per-band statistics of a raster element which are kept per strip of rows.", // tp_doc
+      0,                                                 // tp_traverse
+      0,                                                 // tp_clear
+      0,                                                 // tp_richcompare
+      0,                                                 // tp_weaklistoffset
+      0,                                                 // tp_iter
+      0,                                                 // tp_iternext
+      sStatisticsEngineMethods                           // tp_methods
+   };
+}
+
+namespace BandStatistics
+{
+   PyObject* aoi_reduce(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pAoiHandle = NULL;
+      PyObject* pRasterHandle = NULL;
+      PyObject* pBands = NULL;
+      unsigned int bins = 0;
+      if (!PyArg_ParseTuple(pArgs, "OOOI", &pAoiHandle, &pRasterHandle, &pBands, &bins))
+      {
+         return NULL;
+      }
+      AoiElement* pAoi = AoiMask::toAoiElement(pAoiHandle);
+      if (pAoi == NULL)
+      {
+         return NULL;
+      }
+      RasterElement* pRaster = RasterBuffer::toRasterElement(pRasterHandle);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      if (!checkEncoding(pDesc))
+      {
+         return NULL;
+      }
+      const BitMask* pMask = pAoi->getSelectedPoints();
+      if (pMask == NULL)
+      {
+         PyErr_SetString(PyExc_RuntimeError, "The AOI has no selected points.");
+         return NULL;
+      }
+
+      // read the smallest contiguous band range which contains all of the requested bands
+      std::vector<unsigned int> bands;
+      if (!parseBands(pBands, pDesc, bands))
+      {
+         return NULL;
+      }
+      if (bands.empty())
+      {
+         return PyList_New(0);
+      }
+      const unsigned int firstBand = *std::min_element(bands.begin(), bands.end());
+      std::vector<unsigned int> bandOffsets;
+      for (std::vector<unsigned int>::const_iterator band = bands.begin(); band != bands.end(); ++band)
+      {
+         bandOffsets.push_back(*band - firstBand);
+      }
+
+      // an inverted mask may select pixels anywhere in the raster element
+      int minColumn = 0;
+      int minRow = 0;
+      int maxColumn = static_cast<int>(pDesc->getColumnCount()) - 1;
+      int maxRow = static_cast<int>(pDesc->getRowCount()) - 1;
+      if (!pMask->isOutsideSelected())
+      {
+         int x1 = 0;
+         int y1 = 0;
+         int x2 = 0;
+         int y2 = 0;
+         pMask->getMinimalBoundingBox(x1, y1, x2, y2);
+         minColumn = std::max(minColumn, std::min(x1, x2));
+         minRow = std::max(minRow, std::min(y1, y2));
+         maxColumn = std::min(maxColumn, std::max(x1, x2));
+         maxRow = std::min(maxRow, std::max(y1, y2));
+      }
+
+      std::vector<Accumulator> accumulators(bands.size());
+      std::vector<Histogram> histograms;
+      if (minColumn <= maxColumn && minRow <= maxRow && pMask->getCount() != 0)
+      {
+         SubCube region;
+         region.mStart[ROW_DIM] = minRow;
+         region.mEnd[ROW_DIM] = maxRow;
+         region.mStart[COLUMN_DIM] = minColumn;
+         region.mEnd[COLUMN_DIM] = maxColumn;
+         region.mStart[BAND_DIM] = firstBand;
+         region.mEnd[BAND_DIM] = *std::max_element(bands.begin(), bands.end());
+         region.mStep[ROW_DIM] = 1;
+         region.mStep[COLUMN_DIM] = 1;
+         region.mStep[BAND_DIM] = 1;
+         const size_t columns = region.count(COLUMN_DIM);
+         char* pSelected = new (std::nothrow) char[region.count(ROW_DIM) * columns];
+         if (pSelected == NULL)
+         {
+            return PyErr_NoMemory();
+         }
+
+         bool success = false;
+         Py_BEGIN_ALLOW_THREADS
+         for (int row = minRow; row <= maxRow; ++row)
+         {
+            char* pRow = pSelected + (row - minRow) * columns;
+            for (int column = minColumn; column <= maxColumn; ++column)
+            {
+               pRow[column - minColumn] = pMask->getPixel(column, row) ? 1 : 0;
+            }
+         }
+         success = reduceRegion(pRaster, region, pSelected, bandOffsets, bins, accumulators, histograms);
+         Py_END_ALLOW_THREADS
+         delete [] pSelected;
+         if (!success)
+         {
+            PyErr_SetString(PyExc_RuntimeError, "Unable to access the raster element data.");
+            return NULL;
+         }
+      }
+      else if (bins > 0)
+      {
+         histograms.resize(bands.size(), Histogram(bins));
+      }
+
+      PyObject* pResult = PyList_New(bands.size());
+      if (pResult == NULL)
+      {
+         return NULL;
+      }
+      const double nan = std::numeric_limits<double>::quiet_NaN();
+      for (size_t band = 0; band < bands.size(); ++band)
+      {
+         const Accumulator& stats = accumulators[band];
+         PyObject* pHistogram = NULL;
+         if (histograms.empty())
+         {
+            Py_INCREF(Py_None);
+            pHistogram = Py_None;
+         }
+         else
+         {
+            pHistogram = histogramToPython(histograms[band]);
+         }
+         PyObject* pItem = (pHistogram == NULL) ? NULL : Py_BuildValue("(KddddN)", stats.mCount,
+            stats.mCount == 0 ? nan : stats.mMean, sqrt(stats.variance()),
+            stats.mCount == 0 ? nan : stats.mMin, stats.mCount == 0 ? nan : stats.mMax, pHistogram);
+         if (pItem == NULL)
+         {
+            Py_DECREF(pResult);
+            return NULL;
+         }
+         PyList_SET_ITEM(pResult, band, pItem);
+      }
+      return pResult;
+   }
+
+   bool registerType(PyObject* pModule)
+   {
+      if (PyType_Ready(&sStatisticsEngineType) < 0)
+      {
+         return false;
+      }
+      Py_INCREF(&sStatisticsEngineType);
+      return PyModule_AddObject(pModule, "StatisticsEngine", reinterpret_cast<PyObject*>(&sStatisticsEngineType)) == 0;
+   }
+
+   PyObject* statistics_engine(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      PyObject* pBands = NULL;
+      unsigned int bins = 0;
+      double lower = 0.0;
+      double upper = 0.0;
+      unsigned int stripRows = 0;
+      if (!PyArg_ParseTuple(pArgs, "OOIddI", &pHandle, &pBands, &bins, &lower, &upper, &stripRows))
+      {
+         return NULL;
+      }
+      RasterElement* pRaster = RasterBuffer::toRasterElement(pHandle);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      if (!checkEncoding(pDesc))
+      {
+         return NULL;
+      }
+      std::vector<unsigned int> bands;
+      if (!parseBands(pBands, pDesc, bands))
+      {
+         return NULL;
+      }
+      if (bands.empty())
+      {
+         PyErr_SetString(PyExc_ValueError, "At least one band must be specified.");
+         return NULL;
+      }
+      if (stripRows == 0)
+      {
+         PyErr_SetString(PyExc_ValueError, "Strips must contain at least one row.");
+         return NULL;
+      }
+
+      StatisticsEngineObject* pEngine = PyObject_New(StatisticsEngineObject, &sStatisticsEngineType);
+      if (pEngine == NULL)
+      {
+         return NULL;
+      }
+      pEngine->mpEngine = new StatisticsEngine(pRaster, bands, bins, lower, upper, stripRows);
+      return reinterpret_cast<PyObject*>(pEngine);
+   }
+}
@@ -0,0 +1,94 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BANDSTATISTICS_H
+#define BANDSTATISTICS_H
+
+#include "PythonCommon.h"
+
+#include <vector>
+
+/**
+ * Per-band statistics over the pixels of a raster element selected by an AOI.
+ *
+ * The selected region is split into row blocks which are reduced on worker threads.
+ * Each worker reads its rows a chunk at a time and keeps its own accumulators which
+ * are merged once all of the workers have finished.
+ *
+ * A StatisticsEngine keeps the accumulators of each strip of rows of a whole raster element
+ * instead of merging them, so the statistics can be brought up to date after part of the
+ * raster element is written by reducing only the strips which contain the written rows.
+ */
+namespace BandStatistics
+{
+   /**
+    * Running count, mean, variance and extrema of a set of values.
+    * Accumulators of disjoint sets of values can be merged.
+    */
+   struct Accumulator
+   {
+      Accumulator();
+
+      void add(double value);
+      void merge(const Accumulator& other);
+      double variance() const;
+
+      unsigned long long mCount;
+      double mMean;
+      double mM2;    // sum of squared differences from the mean
+      double mMin;
+      double mMax;
+   };
+
+   /**
+    * A histogram with equal width bins over an inclusive range.
+    * Values outside of the range are not counted.
+    */
+   struct Histogram
+   {
+      Histogram(unsigned int bins = 0, double lower = 0.0, double upper = 0.0);
+
+      void add(double value);
+      void merge(const Histogram& other);
+
+      double mLower;
+      double mUpper;
+      double mScale;   // bins per unit value
+      std::vector<unsigned long long> mCounts;
+   };
+
+   /**
+    * aoi_reduce(aoi_handle, raster_handle, bands, bins) -> list
+    *
+    * Calculate statistics for each band index in bands over the pixels selected by an AOI.
+    * Each list item is (count, mean, std, min, max, histogram) for the corresponding band.
+    * NaN values are ignored. The histogram is None if bins is zero, otherwise it is
+    * (counts, lower, upper) with bins covering the band's minimum to maximum.
+    */
+   PyObject* aoi_reduce(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * Add the StatisticsEngine type to a module.
+    *
+    * @return True on success, false if a Python exception has been set.
+    */
+   bool registerType(PyObject* pModule);
+
+   /**
+    * statistics_engine(handle, bands, bins, lower, upper, strip_rows) -> StatisticsEngine
+    *
+    * Create the statistics of each band index in bands of a raster element, kept per strip of
+    * strip_rows rows. NaN values are ignored. There are no histograms if bins is zero. Each
+    * histogram covers lower to upper or, if lower is greater than upper, the band's minimum to
+    * maximum when it is first updated. Nothing is read until the engine is updated.
+    */
+   PyObject* statistics_engine(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
@@ -0,0 +1,331 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DataVariant.h"
+#include "DynamicObject.h"
+#include "DynamicObjectDict.h"
+#include "ObjectResource.h"
+#include "VariantArray.h"
+
+#include <limits.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+   DynamicObject* toDynamicObject(PyObject* pHandle)
+   {
+      void* pAddress = (pHandle == Py_None) ? NULL : PyLong_AsVoidPtr(pHandle);
+      if (pAddress == NULL && !PyErr_Occurred())
+      {
+         PyErr_SetString(PyExc_ValueError, "Invalid DynamicObject handle.");
+      }
+      return reinterpret_cast<DynamicObject*>(pAddress);
+   }
+
+   PyObject* toDict(const DynamicObject* pObject, PyObject* pAdopt);
+
+   PyObject* stringToPython(const std::string& value)
+   {
+      return PyString_FromStringAndSize(value.data(), static_cast<Py_ssize_t>(value.size()));
+   }
+
+   PyObject* toPython(const DataVariant& value, PyObject* pAdopt)
+   {
+      if (!value.isValid())
+      {
+         Py_RETURN_NONE;
+      }
+      const std::string& type = value.getTypeName();
+      const void* pValue = value.getPointerToValue();
+      if (type == "DynamicObject")
+      {
+         return toDict(static_cast<const DynamicObject*>(pValue), pAdopt);
+      }
+      PyObject* pNumber = VariantArray::copyValue(type, pValue);
+      if (pNumber != NULL || PyErr_Occurred())
+      {
+         return pNumber;
+      }
+      if (type == "string")
+      {
+         return stringToPython(*static_cast<const std::string*>(pValue));
+      }
+      if (type == "bool")
+      {
+         return PyBool_FromLong(*static_cast<const bool*>(pValue));
+      }
+      if (type == "vector<string>")
+      {
+         const std::vector<std::string>& strings = *static_cast<const std::vector<std::string>*>(pValue);
+         PyObject* pList = PyList_New(strings.size());
+         for (std::vector<std::string>::size_type i = 0; pList != NULL && i < strings.size(); ++i)
+         {
+            PyObject* pItem = stringToPython(strings[i]);
+            if (pItem == NULL)
+            {
+               Py_DECREF(pList);
+               return NULL;
+            }
+            PyList_SET_ITEM(pList, i, pItem);
+         }
+         return pList;
+      }
+
+      // anything else is returned as a copy owned by Python
+      DataVariant* pCopy = new DataVariant(value);
+      PyObject* pAddress = PyLong_FromVoidPtr(pCopy);
+      PyObject* pResult = (pAddress == NULL) ? NULL : PyObject_CallFunctionObjArgs(pAdopt, pAddress, NULL);
+      Py_XDECREF(pAddress);
+      if (pResult == NULL)
+      {
+         delete pCopy;
+      }
+      return pResult;
+   }
+
+   PyObject* toDict(const DynamicObject* pObject, PyObject* pAdopt)
+   {
+      PyObject* pDict = PyDict_New();
+      if (pDict == NULL)
+      {
+         return NULL;
+      }
+      std::vector<std::string> names;
+      pObject->getAttributeNames(names);
+      for (std::vector<std::string>::const_iterator pName = names.begin(); pName != names.end(); ++pName)
+      {
+         PyObject* pValue = toPython(pObject->getAttribute(*pName), pAdopt);
+         if (pValue == NULL || PyDict_SetItemString(pDict, pName->c_str(), pValue) != 0)
+         {
+            Py_XDECREF(pValue);
+            Py_DECREF(pDict);
+            return NULL;
+         }
+         Py_DECREF(pValue);
+      }
+      return pDict;
+   }
+
+   bool isIntValue(PyObject* pValue)
+   {
+      if (!PyInt_Check(pValue) || PyBool_Check(pValue))
+      {
+         return false;
+      }
+      const long value = PyInt_AS_LONG(pValue);
+      return value >= INT_MIN && value <= INT_MAX;
+   }
+
+   bool toString(PyObject* pValue, std::string& value)
+   {
+      if (PyString_Check(pValue))
+      {
+         value.assign(PyString_AS_STRING(pValue), PyString_GET_SIZE(pValue));
+         return true;
+      }
+      if (PyUnicode_Check(pValue))
+      {
+         auto_obj encoded(PyUnicode_AsUTF8String(pValue), true);
+         if (encoded.get() != NULL)
+         {
+            value.assign(PyString_AS_STRING(encoded.get()), PyString_GET_SIZE(encoded.get()));
+            return true;
+         }
+         PyErr_Clear();
+      }
+      return false;
+   }
+
+   /**
+    * Convert a list or tuple of ints, numbers or strings.
+    *
+    * @return False if the items are of mixed or other types.
+    */
+   bool sequenceToVariant(PyObject* pSequence, DataVariant& variant)
+   {
+      const Py_ssize_t count = PySequence_Fast_GET_SIZE(pSequence);
+      PyObject** pItems = PySequence_Fast_ITEMS(pSequence);
+      bool allInts = true;
+      bool allNumbers = true;
+      bool allStrings = true;
+      for (Py_ssize_t i = 0; i < count; ++i)
+      {
+         const bool isInt = isIntValue(pItems[i]);
+         allInts = allInts && isInt;
+         allNumbers = allNumbers && (isInt || PyFloat_Check(pItems[i]));
+         allStrings = allStrings && (PyString_Check(pItems[i]) || PyUnicode_Check(pItems[i]));
+      }
+      if (count == 0 || (allNumbers && !allInts))
+      {
+         std::vector<double> values(count);
+         for (Py_ssize_t i = 0; i < count; ++i)
+         {
+            values[i] = PyFloat_Check(pItems[i]) ? PyFloat_AS_DOUBLE(pItems[i]) : PyInt_AS_LONG(pItems[i]);
+         }
+         DataVariant(values).swap(variant);
+         return true;
+      }
+      if (allInts)
+      {
+         std::vector<int> values(count);
+         for (Py_ssize_t i = 0; i < count; ++i)
+         {
+            values[i] = static_cast<int>(PyInt_AS_LONG(pItems[i]));
+         }
+         DataVariant(values).swap(variant);
+         return true;
+      }
+      if (allStrings)
+      {
+         std::vector<std::string> values(count);
+         for (Py_ssize_t i = 0; i < count; ++i)
+         {
+            if (!toString(pItems[i], values[i]))
+            {
+               return false;
+            }
+         }
+         DataVariant(values).swap(variant);
+         return true;
+      }
+      return false;
+   }
+
+   bool toVariant(PyObject* pValue, PyObject* pConvert, DataVariant& variant)
+   {
+      std::string text;
+      if (PyBool_Check(pValue))
+      {
+         DataVariant(pValue == Py_True).swap(variant);
+         return true;
+      }
+      if (isIntValue(pValue))
+      {
+         DataVariant(static_cast<int>(PyInt_AS_LONG(pValue))).swap(variant);
+         return true;
+      }
+      if (PyFloat_Check(pValue))
+      {
+         DataVariant(PyFloat_AS_DOUBLE(pValue)).swap(variant);
+         return true;
+      }
+      if (toString(pValue, text))
+      {
+         DataVariant(text).swap(variant);
+         return true;
+      }
+      if ((PyList_Check(pValue) || PyTuple_Check(pValue)) && sequenceToVariant(pValue, variant))
+      {
+         return true;
+      }
+
+      auto_obj converted(PyObject_CallFunctionObjArgs(pConvert, pValue, NULL), true);
+      if (converted.get() == NULL)
+      {
+         return false;
+      }
+      auto_obj handle(PyObject_GetAttrString(converted, "handle"), true);
+      if (handle.get() == NULL)
+      {
+         return false;
+      }
+      const DataVariant* pVariant = reinterpret_cast<const DataVariant*>(
+         handle.get() == Py_None ? NULL : PyLong_AsVoidPtr(handle));
+      if (pVariant == NULL)
+      {
+         if (!PyErr_Occurred())
+         {
+            PyErr_SetString(PyExc_ValueError, "The value could not be converted to a DataVariant.");
+         }
+         return false;
+      }
+      variant = *pVariant;
+      return true;
+   }
+
+   bool update(DynamicObject* pObject, PyObject* pValues, PyObject* pConvert)
+   {
+      PyObject* pKey = NULL;
+      PyObject* pValue = NULL;
+      Py_ssize_t position = 0;
+      while (PyDict_Next(pValues, &position, &pKey, &pValue))
+      {
+         std::string name;
+         if (!toString(pKey, name))
+         {
+            PyErr_SetString(PyExc_TypeError, "DynamicObject attribute names must be strings.");
+            return false;
+         }
+         if (PyDict_Check(pValue))
+         {
+            DynamicObject* pChild = dv_cast<DynamicObject>(&pObject->getAttribute(name));
+            if (pChild != NULL)
+            {
+               if (!update(pChild, pValue, pConvert))
+               {
+                  return false;
+               }
+               continue;
+            }
+            FactoryResource<DynamicObject> pNewChild;
+            if (!update(pNewChild.get(), pValue, pConvert))
+            {
+               return false;
+            }
+            DataVariant child(*pNewChild.get());
+            pObject->adoptAttribute(name, child);
+            continue;
+         }
+         DataVariant variant;
+         if (!toVariant(pValue, pConvert, variant))
+         {
+            return false;
+         }
+         pObject->adoptAttribute(name, variant);
+      }
+      return true;
+   }
+}
+
+namespace DynamicObjectDict
+{
+   PyObject* dynamic_object_to_dict(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      PyObject* pAdopt = NULL;
+      if (!PyArg_ParseTuple(pArgs, "OO", &pHandle, &pAdopt))
+      {
+         return NULL;
+      }
+      DynamicObject* pObject = toDynamicObject(pHandle);
+      if (pObject == NULL)
+      {
+         return NULL;
+      }
+      return toDict(pObject, pAdopt);
+   }
+
+   PyObject* dynamic_object_update(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      PyObject* pValues = NULL;
+      PyObject* pConvert = NULL;
+      if (!PyArg_ParseTuple(pArgs, "OO!O", &pHandle, &PyDict_Type, &pValues, &pConvert))
+      {
+         return NULL;
+      }
+      DynamicObject* pObject = toDynamicObject(pHandle);
+      if (pObject == NULL || !update(pObject, pValues, pConvert))
+      {
+         return NULL;
+      }
+      Py_RETURN_NONE;
+   }
+}
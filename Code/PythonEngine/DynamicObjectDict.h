@@ -0,0 +1,44 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef DYNAMICOBJECTDICT_H
+#define DYNAMICOBJECTDICT_H
+
+#include "PythonCommon.h"
+
+/**
+ * Copies whole DynamicObject trees to and from Python dicts in a single call.
+ *
+ * Nested DynamicObjects are dicts. Numbers, bools and strings, and vectors of numbers and
+ * strings, are converted natively. Other values are passed through Python callables which
+ * convert between opticks.DataVariant objects and DataVariant addresses.
+ */
+namespace DynamicObjectDict
+{
+   /**
+    * dynamic_object_to_dict(handle, adopt) -> dict
+    *
+    * Copy the attributes of a DynamicObject. adopt(address) is called with a new
+    * DataVariant for each value which is not converted natively and must return an
+    * object which owns it.
+    */
+   PyObject* dynamic_object_to_dict(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * dynamic_object_update(handle, values, convert)
+    *
+    * Set attributes of a DynamicObject from a dict. Nested dicts are merged into
+    * existing child DynamicObjects. convert(value) is called for each value which
+    * is not converted natively and must return an object with the address of a
+    * DataVariant in its handle attribute.
+    */
+   PyObject* dynamic_object_update(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "InputTracker.h"
+
+#include <ctype.h>
+
+namespace
+{
+   std::string firstWord(const std::string& line, std::string::size_type start)
+   {
+      std::string::size_type end = start;
+      while (end < line.size() && (isalnum(static_cast<unsigned char>(line[end])) || line[end] == '_'))
+      {
+         ++end;
+      }
+      return line.substr(start, end - start);
+   }
+
+   bool isCompoundKeyword(const std::string& word)
+   {
+      static const char* const spKeywords[] = {
+         "if", "elif", "else", "while", "for", "try", "except", "finally", "with", "def", "class"
+      };
+      for (unsigned int i = 0; i < sizeof(spKeywords) / sizeof(spKeywords[0]); ++i)
+      {
+         if (word == spKeywords[i])
+         {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   bool isClauseKeyword(const std::string& word)
+   {
+      return word == "elif" || word == "else" || word == "except" || word == "finally";
+   }
+}
+
+InputTracker::InputTracker()
+{
+   reset();
+}
+
+void InputTracker::addLine(const std::string& text)
+{
+   std::string line(text);
+   if (!line.empty() && line[line.size() - 1] == '\r')
+   {
+      line.erase(line.size() - 1);
+   }
+
+   const bool logicalLineOpen = mDepth > 0 || mQuote != 0 || mContinued;
+   if (!logicalLineOpen)
+   {
+      std::string::size_type first = line.find_first_not_of(" \t\f");
+      if (first == std::string::npos)
+      {
+         // a blank line ends a compound statement
+         if (!mStatement.empty())
+         {
+            completeStatement();
+         }
+         return;
+      }
+      if (line[first] == '#')
+      {
+         if (!mStatement.empty())
+         {
+            mStatement += line;
+            mStatement += '\n';
+         }
+         return;
+      }
+
+      std::string word = firstWord(line, first);
+      if (mCompound && first == 0 && !mDecorated && !isClauseKeyword(word))
+      {
+         completeStatement();
+      }
+      if (line[first] == '@')
+      {
+         mCompound = true;
+         mDecorated = true;
+      }
+      else if (isCompoundKeyword(word))
+      {
+         mCompound = true;
+         if (word == "def" || word == "class")
+         {
+            mDecorated = false;
+         }
+      }
+   }
+
+   mStatement += line;
+   mStatement += '\n';
+   scanLine(line);
+
+   if (!mCompound && mDepth == 0 && mQuote == 0 && !mContinued)
+   {
+      completeStatement();
+   }
+}
+
+void InputTracker::finishBlock()
+{
+   if (!mStatement.empty() && mDepth == 0 && mQuote == 0 && !mContinued)
+   {
+      completeStatement();
+   }
+}
+
+bool InputTracker::takeStatement(std::string& statement)
+{
+   if (mComplete.empty())
+   {
+      return false;
+   }
+   statement.swap(mComplete.front());
+   mComplete.pop_front();
+   return true;
+}
+
+bool InputTracker::isPending() const
+{
+   return !mStatement.empty();
+}
+
+void InputTracker::reset()
+{
+   mComplete.clear();
+   mStatement.clear();
+   mDepth = 0;
+   mQuote = 0;
+   mTripleQuote = false;
+   mContinued = false;
+   mCompound = false;
+   mDecorated = false;
+}
+
+void InputTracker::scanLine(const std::string& line)
+{
+   const std::string::size_type length = line.size();
+   bool escapedNewline = false;
+   mContinued = false;
+   for (std::string::size_type i = 0; i < length; ++i)
+   {
+      const char c = line[i];
+      if (mQuote != 0)
+      {
+         if (c == '\\')
+         {
+            escapedNewline = (i + 1 == length);
+            ++i;
+         }
+         else if (c == mQuote)
+         {
+            if (!mTripleQuote)
+            {
+               mQuote = 0;
+            }
+            else if (i + 2 < length && line[i + 1] == c && line[i + 2] == c)
+            {
+               mQuote = 0;
+               i += 2;
+            }
+         }
+         continue;
+      }
+
+      if (c == '#')
+      {
+         break;
+      }
+      switch (c)
+      {
+      case '\'':
+      case '"':
+         mQuote = c;
+         mTripleQuote = (i + 2 < length && line[i + 1] == c && line[i + 2] == c);
+         if (mTripleQuote)
+         {
+            i += 2;
+         }
+         break;
+      case '(':
+      case '[':
+      case '{':
+         ++mDepth;
+         break;
+      case ')':
+      case ']':
+      case '}':
+         if (mDepth > 0)
+         {
+            --mDepth;
+         }
+         break;
+      case '\\':
+         mContinued = (i + 1 == length);
+         break;
+      default:
+         break;
+      }
+   }
+
+   // an unterminated single quoted string is an error which the compiler will report
+   if (mQuote != 0 && !mTripleQuote && !escapedNewline)
+   {
+      mQuote = 0;
+   }
+}
+
+void InputTracker::completeStatement()
+{
+   mComplete.push_back(std::string());
+   mComplete.back().swap(mStatement);
+   mCompound = false;
+   mDecorated = false;
+}
@@ -0,0 +1,81 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef INPUTTRACKER_H
+#define INPUTTRACKER_H
+
+#include <deque>
+#include <string>
+
+/**
+ * Splits interactive input into complete Python statements.
+ *
+ * Each line is scanned once as it is added and the bracket depth, string and line continuation
+ * state are carried over to the next line, so the cost of a statement is linear in its length.
+ * A simple statement is complete at the end of its logical line. A compound statement is complete
+ * at the first blank line, or at the first unindented line which does not continue it, such as
+ * an else or except clause.
+ *
+ * Only enough of the Python lexical rules are followed to find statement boundaries.
+ * Invalid input is passed on as a statement so the compiler can report the error.
+ */
+class InputTracker
+{
+public:
+   InputTracker();
+
+   /**
+    * Add a line of input.
+    *
+    * @param line
+    *        The text of the line without the line terminator.
+    */
+   void addLine(const std::string& line);
+
+   /**
+    * End a pending compound statement as if a blank line had been entered.
+    * Nothing happens if a logical line is still open, such as inside brackets.
+    */
+   void finishBlock();
+
+   /**
+    * Remove the next complete statement.
+    *
+    * @param statement
+    *        Set to the source of the statement, including a trailing newline.
+    *
+    * @return False if there are no complete statements.
+    */
+   bool takeStatement(std::string& statement);
+
+   /**
+    * Is there input which is not yet part of a complete statement?
+    */
+   bool isPending() const;
+
+   /**
+    * Discard all input.
+    */
+   void reset();
+
+private:
+   void scanLine(const std::string& line);
+   void completeStatement();
+
+   std::deque<std::string> mComplete;
+   std::string mStatement;
+   int mDepth;                // open brackets
+   char mQuote;               // the quote character of an open string or 0
+   bool mTripleQuote;
+   bool mContinued;           // the last line ended with a backslash
+   bool mCompound;            // the statement is a compound statement such as an if or a def
+   bool mDecorated;           // the statement started with a decorator and has not reached its def or class
+};
+
+#endif
@@ -0,0 +1,409 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "InterleaveConversion.h"
+
+#include <QtCore/QThread>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+   // the edge of a square block of items; a block of 8 byte items is 8 KB
+   const Py_ssize_t sBlockSize = 32;
+
+   // copies smaller than this are done on the calling thread
+   const Py_ssize_t sParallelBytes = 4 * 1024 * 1024;
+
+   /**
+    * Copy a line of items. pContext is the item size for copies and the Scaling for conversions.
+    */
+   typedef void (*CopyLineFunc)(char* pDest, Py_ssize_t destStride, const char* pSource, Py_ssize_t sourceStride,
+      Py_ssize_t count, const void* pContext);
+
+   void copyContiguousLine(char* pDest, Py_ssize_t, const char* pSource, Py_ssize_t, Py_ssize_t count,
+      const void* pContext)
+   {
+      memcpy(pDest, pSource, count * *static_cast<const Py_ssize_t*>(pContext));
+   }
+
+   template<typename T>
+   void copyLine(char* pDest, Py_ssize_t destStride, const char* pSource, Py_ssize_t sourceStride, Py_ssize_t count,
+      const void*)
+   {
+      if (destStride == static_cast<Py_ssize_t>(sizeof(T)))
+      {
+         T* pDestItems = reinterpret_cast<T*>(pDest);
+         for (Py_ssize_t idx = 0; idx < count; ++idx)
+         {
+            pDestItems[idx] = *reinterpret_cast<const T*>(pSource + idx * sourceStride);
+         }
+         return;
+      }
+      for (Py_ssize_t idx = 0; idx < count; ++idx)
+      {
+         *reinterpret_cast<T*>(pDest + idx * destStride) = *reinterpret_cast<const T*>(pSource + idx * sourceStride);
+      }
+   }
+
+   void copyUnalignedLine(char* pDest, Py_ssize_t destStride, const char* pSource, Py_ssize_t sourceStride,
+      Py_ssize_t count, const void* pContext)
+   {
+      const Py_ssize_t itemSize = *static_cast<const Py_ssize_t*>(pContext);
+      for (Py_ssize_t idx = 0; idx < count; ++idx)
+      {
+         memcpy(pDest + idx * destStride, pSource + idx * sourceStride, itemSize);
+      }
+   }
+
+   /**
+    * Select the fastest line copy for an item size. The typed copies are only used if every item is
+    * aligned to its size, since some platforms fault on unaligned loads.
+    */
+   CopyLineFunc selectCopyLine(Py_ssize_t itemSize, bool contiguous, bool aligned)
+   {
+      if (contiguous)
+      {
+         return copyContiguousLine;
+      }
+      if (aligned)
+      {
+         switch (itemSize)
+         {
+         case 1:
+            return copyLine<unsigned char>;
+         case 2:
+            return copyLine<unsigned short>;
+         case 4:
+            return copyLine<unsigned int>;
+         case 8:
+            return copyLine<unsigned long long>;
+         default:
+            break;
+         }
+      }
+      return copyUnalignedLine;
+   }
+
+   struct Scaling
+   {
+      double mScale;
+      double mOffset;
+   };
+
+   /**
+    * Convert a line of items. Items are loaded and stored with memcpy since either side may be unaligned.
+    */
+   template<typename S, typename D>
+   void convertLine(char* pDest, Py_ssize_t destStride, const char* pSource, Py_ssize_t sourceStride,
+      Py_ssize_t count, const void* pContext)
+   {
+      const Scaling& scaling = *static_cast<const Scaling*>(pContext);
+      const bool isInteger = std::numeric_limits<D>::is_integer;
+      const bool isNarrower = std::numeric_limits<D>::max() < std::numeric_limits<double>::max();
+      const double low = isInteger ? std::numeric_limits<D>::min() : -std::numeric_limits<D>::max();
+      const double high = std::numeric_limits<D>::max();
+      for (Py_ssize_t idx = 0; idx < count; ++idx)
+      {
+         S source;
+         memcpy(&source, pSource + idx * sourceStride, sizeof(S));
+         double value = static_cast<double>(source) * scaling.mScale + scaling.mOffset;
+         if (isInteger)
+         {
+            // NaN fails both comparisons and becomes the minimum
+            value = floor(value + 0.5);
+            value = value > low ? value : low;
+            value = value < high ? value : high;
+         }
+         else if (isNarrower)
+         {
+            value = value < low ? low : (value > high ? high : value);
+         }
+         const D dest = static_cast<D>(value);
+         memcpy(pDest + idx * destStride, &dest, sizeof(D));
+      }
+   }
+
+   // indexed by EncodingTypeEnum
+   template<typename S>
+   CopyLineFunc selectConvertLine(int destEncoding)
+   {
+      switch (destEncoding)
+      {
+      case 0:  // INT1SBYTE
+         return convertLine<S, signed char>;
+      case 1:  // INT1UBYTE
+         return convertLine<S, unsigned char>;
+      case 2:  // INT2SBYTES
+         return convertLine<S, short>;
+      case 3:  // INT2UBYTES
+         return convertLine<S, unsigned short>;
+      case 5:  // INT4SBYTES
+         return convertLine<S, int>;
+      case 6:  // INT4UBYTES
+         return convertLine<S, unsigned int>;
+      case 7:  // FLT4BYTES
+         return convertLine<S, float>;
+      case 9:  // FLT8BYTES
+         return convertLine<S, double>;
+      default:  // complex encodings
+         return NULL;
+      }
+   }
+
+   CopyLineFunc selectConvertLine(char sourceFormat, int destEncoding)
+   {
+      switch (sourceFormat)
+      {
+      case '?':
+      case 'B':
+         return selectConvertLine<unsigned char>(destEncoding);
+      case 'b':
+         return selectConvertLine<signed char>(destEncoding);
+      case 'h':
+         return selectConvertLine<short>(destEncoding);
+      case 'H':
+         return selectConvertLine<unsigned short>(destEncoding);
+      case 'i':
+         return selectConvertLine<int>(destEncoding);
+      case 'I':
+         return selectConvertLine<unsigned int>(destEncoding);
+      case 'l':
+         return selectConvertLine<long>(destEncoding);
+      case 'L':
+         return selectConvertLine<unsigned long>(destEncoding);
+      case 'q':
+         return selectConvertLine<long long>(destEncoding);
+      case 'Q':
+         return selectConvertLine<unsigned long long>(destEncoding);
+      case 'f':
+         return selectConvertLine<float>(destEncoding);
+      case 'd':
+         return selectConvertLine<double>(destEncoding);
+      default:
+         return NULL;
+      }
+   }
+
+   /**
+    * A copy arranged as an outer loop around lines of a plane. Index 0 of each array is the outer
+    * dimension, 1 is the dimension across lines and 2 is the destination's innermost dimension.
+    */
+   struct CopyPlan
+   {
+      char* mpDest;
+      const char* mpSource;
+      Py_ssize_t mDestStrides[3];
+      Py_ssize_t mSourceStrides[3];
+      Py_ssize_t mCounts[3];
+      const void* mpContext;
+      bool mBlocked;
+      CopyLineFunc mpCopyLine;
+
+      void run(Py_ssize_t outerBegin, Py_ssize_t outerEnd) const
+      {
+         const Py_ssize_t blockSize = mBlocked ? sBlockSize : std::max<Py_ssize_t>(mCounts[1], 1);
+         for (Py_ssize_t outer = outerBegin; outer < outerEnd; ++outer)
+         {
+            char* pDest = mpDest + outer * mDestStrides[0];
+            const char* pSource = mpSource + outer * mSourceStrides[0];
+            for (Py_ssize_t innerStart = 0; innerStart < mCounts[2]; innerStart += blockSize)
+            {
+               const Py_ssize_t innerCount = mBlocked ? std::min(blockSize, mCounts[2] - innerStart) : mCounts[2];
+               for (Py_ssize_t lineStart = 0; lineStart < mCounts[1]; lineStart += blockSize)
+               {
+                  const Py_ssize_t lineEnd = std::min(lineStart + blockSize, mCounts[1]);
+                  for (Py_ssize_t line = lineStart; line < lineEnd; ++line)
+                  {
+                     mpCopyLine(pDest + line * mDestStrides[1] + innerStart * mDestStrides[2], mDestStrides[2],
+                        pSource + line * mSourceStrides[1] + innerStart * mSourceStrides[2], mSourceStrides[2],
+                        innerCount, mpContext);
+                  }
+               }
+               if (!mBlocked)
+               {
+                  break;
+               }
+            }
+         }
+      }
+   };
+
+   class CopyThread : public QThread
+   {
+   public:
+      CopyThread(const CopyPlan& plan, Py_ssize_t outerBegin, Py_ssize_t outerEnd) :
+         mPlan(plan),
+         mOuterBegin(outerBegin),
+         mOuterEnd(outerEnd)
+      {
+      }
+
+   protected:
+      virtual void run()
+      {
+         mPlan.run(mOuterBegin, mOuterEnd);
+      }
+
+   private:
+      CopyThread(const CopyThread& rhs);
+      CopyThread& operator=(const CopyThread& rhs);
+
+      const CopyPlan& mPlan;
+      Py_ssize_t mOuterBegin;
+      Py_ssize_t mOuterEnd;
+   };
+
+   Py_ssize_t magnitude(Py_ssize_t stride)
+   {
+      return stride < 0 ? -stride : stride;
+   }
+
+   /**
+    * Arrange a copy so the loop outside the lines is the one which isn't in the plane of the
+    * destination's innermost dimension and the source's fastest dimension.
+    *
+    * @return False if the cube is empty.
+    */
+   bool preparePlan(CopyPlan& plan, char* pDest, const Py_ssize_t* pDestStrides, const char* pSource,
+      const Py_ssize_t* pSourceStrides, const Py_ssize_t* pCounts, const int* pDestOrder)
+   {
+      int outer = pDestOrder[0];
+      int middle = pDestOrder[1];
+      const int inner = pDestOrder[2];
+      if (magnitude(pSourceStrides[outer]) < magnitude(pSourceStrides[middle]))
+      {
+         std::swap(outer, middle);
+      }
+      plan.mpDest = pDest;
+      plan.mpSource = pSource;
+      const int dims[3] = {outer, middle, inner};
+      for (int idx = 0; idx < 3; ++idx)
+      {
+         plan.mDestStrides[idx] = pDestStrides[dims[idx]];
+         plan.mSourceStrides[idx] = pSourceStrides[dims[idx]];
+         plan.mCounts[idx] = pCounts[dims[idx]];
+         if (plan.mCounts[idx] <= 0)
+         {
+            return false;
+         }
+      }
+      plan.mBlocked = magnitude(plan.mSourceStrides[1]) < magnitude(plan.mSourceStrides[2]);
+      return true;
+   }
+
+   /**
+    * Run a plan, splitting it across threads if it moves at least sParallelBytes.
+    */
+   void executePlan(const CopyPlan& plan, Py_ssize_t bytes)
+   {
+      Py_ssize_t threadCount = 1;
+      if (bytes >= sParallelBytes)
+      {
+         threadCount = std::min<Py_ssize_t>(std::max(QThread::idealThreadCount(), 1), plan.mCounts[0]);
+         threadCount = std::min<Py_ssize_t>(threadCount, bytes / (sParallelBytes / 4));
+      }
+      if (threadCount <= 1)
+      {
+         plan.run(0, plan.mCounts[0]);
+         return;
+      }
+
+      // the calling thread copies the first slice
+      const Py_ssize_t sliceSize = (plan.mCounts[0] + threadCount - 1) / threadCount;
+      std::vector<CopyThread*> threads;
+      for (Py_ssize_t begin = sliceSize; begin < plan.mCounts[0]; begin += sliceSize)
+      {
+         threads.push_back(new CopyThread(plan, begin, std::min(begin + sliceSize, plan.mCounts[0])));
+         threads.back()->start();
+      }
+      plan.run(0, std::min(sliceSize, plan.mCounts[0]));
+      for (std::vector<CopyThread*>::iterator pThread = threads.begin(); pThread != threads.end(); ++pThread)
+      {
+         (*pThread)->wait();
+         delete *pThread;
+      }
+   }
+}
+
+namespace InterleaveConversion
+{
+   void copy(char* pDest, const Py_ssize_t* pDestStrides, const char* pSource, const Py_ssize_t* pSourceStrides,
+      const Py_ssize_t* pCounts, const int* pDestOrder, Py_ssize_t itemSize)
+   {
+      CopyPlan plan;
+      if (!preparePlan(plan, pDest, pDestStrides, pSource, pSourceStrides, pCounts, pDestOrder))
+      {
+         return;
+      }
+      bool aligned = reinterpret_cast<size_t>(pDest) % itemSize == 0 &&
+         reinterpret_cast<size_t>(pSource) % itemSize == 0;
+      for (int idx = 0; idx < 3; ++idx)
+      {
+         aligned = aligned && plan.mDestStrides[idx] % itemSize == 0 && plan.mSourceStrides[idx] % itemSize == 0;
+      }
+      const bool contiguous = plan.mDestStrides[2] == itemSize && plan.mSourceStrides[2] == itemSize;
+      plan.mBlocked = plan.mBlocked && !contiguous;
+      plan.mpCopyLine = selectCopyLine(itemSize, contiguous, aligned);
+      plan.mpContext = &itemSize;
+      executePlan(plan, pCounts[0] * pCounts[1] * pCounts[2] * itemSize);
+   }
+
+   Py_ssize_t convertibleSize(char sourceFormat)
+   {
+      switch (sourceFormat)
+      {
+      case '?':
+      case 'B':
+      case 'b':
+         return 1;
+      case 'h':
+      case 'H':
+         return sizeof(short);
+      case 'i':
+      case 'I':
+         return sizeof(int);
+      case 'l':
+      case 'L':
+         return sizeof(long);
+      case 'q':
+      case 'Q':
+         return sizeof(long long);
+      case 'f':
+         return sizeof(float);
+      case 'd':
+         return sizeof(double);
+      default:
+         return 0;
+      }
+   }
+
+   bool convert(char* pDest, const Py_ssize_t* pDestStrides, const char* pSource, const Py_ssize_t* pSourceStrides,
+      const Py_ssize_t* pCounts, const int* pDestOrder, char sourceFormat, int destEncoding, double scale,
+      double offset)
+   {
+      CopyPlan plan;
+      plan.mpCopyLine = selectConvertLine(sourceFormat, destEncoding);
+      if (plan.mpCopyLine == NULL)
+      {
+         return false;
+      }
+      if (!preparePlan(plan, pDest, pDestStrides, pSource, pSourceStrides, pCounts, pDestOrder))
+      {
+         return true;
+      }
+      Scaling scaling = {scale, offset};
+      plan.mpContext = &scaling;
+      executePlan(plan, pCounts[0] * pCounts[1] * pCounts[2] * convertibleSize(sourceFormat));
+      return true;
+   }
+}
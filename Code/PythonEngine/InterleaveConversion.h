@@ -0,0 +1,80 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef INTERLEAVECONVERSION_H
+#define INTERLEAVECONVERSION_H
+
+#include "PythonCommon.h"
+
+/**
+ * Copies raster cubes between interleaves.
+ *
+ * When the innermost dimension of the destination is strided in the source, as in BIP to BSQ,
+ * the copy is done in square blocks of the destination's innermost dimension and the source's
+ * fastest dimension so both sides of each block stay in cache. Items of 1, 2, 4 and 8 bytes,
+ * which covers every Encoding, are copied one at a time as integers of that size instead of
+ * with memcpy. Large copies are split across threads along the dimension which is outside
+ * the blocks.
+ *
+ * Conversions use the same blocking and threading to convert real numbers to a raster encoding
+ * as they are copied, so no converted copy of the source is needed.
+ */
+namespace InterleaveConversion
+{
+   /**
+    * Copy every item of a cube between two strided layouts.
+    * This does not use any Python objects so it should be called without holding the GIL.
+    *
+    * @param pDest
+    *        The first item of the destination.
+    * @param pDestStrides
+    *        The byte strides of the destination, indexed by RasterBuffer::Dimension.
+    * @param pSource
+    *        The first item of the source.
+    * @param pSourceStrides
+    *        The byte strides of the source, indexed by RasterBuffer::Dimension.
+    * @param pCounts
+    *        The number of items in each dimension, indexed by RasterBuffer::Dimension.
+    * @param pDestOrder
+    *        The dimensions of the destination from outermost to innermost.
+    * @param itemSize
+    *        The size of each item in bytes.
+    */
+   void copy(char* pDest, const Py_ssize_t* pDestStrides, const char* pSource, const Py_ssize_t* pSourceStrides,
+      const Py_ssize_t* pCounts, const int* pDestOrder, Py_ssize_t itemSize);
+
+   /**
+    * The item size of a struct module format which convert() accepts.
+    *
+    * @return The size in bytes or 0 if the format is not a real number or bool format.
+    */
+   Py_ssize_t convertibleSize(char sourceFormat);
+
+   /**
+    * Copy every item of a cube between two strided layouts, converting it to an encoding.
+    * Each value is multiplied by scale and offset is added. For integer encodings the result
+    * is rounded to the nearest integer, with halves rounded up, and clamped to the range of the
+    * encoding; NaN becomes the minimum. For FLT4BYTES the result is clamped to the range of a
+    * float. This does not use any Python objects so it should be called without holding the GIL.
+    *
+    * @param sourceFormat
+    *        The struct module format of the source items in native byte order.
+    * @param destEncoding
+    *        The EncodingType of the destination.
+    *
+    * @return False if the source format or encoding is not supported. Complex encodings are not.
+    *
+    * @see copy()
+    */
+   bool convert(char* pDest, const Py_ssize_t* pDestStrides, const char* pSource, const Py_ssize_t* pSourceStrides,
+      const Py_ssize_t* pCounts, const int* pDestOrder, char sourceFormat, int destEncoding, double scale,
+      double offset);
+}
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "InterpreterThread.h"
+#include "OutputStream.h"
+#include "Progress.h"
+#include "PythonCommon.h"
+#include "PythonEngine.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEventLoop>
+#include <QtCore/QMutexLocker>
+
+#include <algorithm>
+
+namespace
+{
+   // interval at which events are processed while waiting for a command
+   const unsigned long EVENT_INTERVAL_MS = 20;
+}
+
+InterpreterThread::InterpreterThread(PythonEngine* pEngine) :
+   mpEngine(pEngine),
+   mpRunning(NULL),
+   mpCurrentContext(NULL),
+   mThreadId(0),
+   mStop(false)
+{
+}
+
+InterpreterThread::~InterpreterThread()
+{
+   mMutex.lock();
+   mStop = true;
+   mQueued.wakeAll();
+   mMutex.unlock();
+   wait();
+}
+
+bool InterpreterThread::execute(const std::string& command, ScopedContext* pContext)
+{
+   Command queued;
+   queued.mText = command;
+   queued.mpContext = pContext;
+   queued.mFinished = false;
+   queued.mResult = false;
+
+   QThread* pCaller = QThread::currentThread();
+   QMutexLocker lock(&mMutex);
+   if (std::find(mWaiting.begin(), mWaiting.end(), pCaller) != mWaiting.end())
+   {
+      // an event processed while this thread waits must not start a command which the running one would block
+      lock.unlock();
+      mpEngine->sendOutput("A Python command is already running. Wait for it to finish.\n", true, pContext);
+      return false;
+   }
+   mWaiting.push_back(pCaller);
+   mCommands.push_back(&queued);
+   mQueued.wakeAll();
+   for (;;)
+   {
+      // everything the command queued before it finished is taken with the finished flag
+      std::deque<Delivery> deliveries;
+      deliveries.swap(queued.mDeliveries);
+      const bool finished = queued.mFinished;
+      Delivery stale;
+      if (!finished && mpRunning == &queued && mpCurrentContext == queued.mpContext &&
+         OutputStream::takeStale(mThreadId, stale.mText, stale.mError))
+      {
+         // buffered text is newer than anything the command has queued
+         stale.mpContext = queued.mpContext;
+         stale.mpProgress = NULL;
+         stale.mPercent = 0;
+         deliveries.push_back(stale);
+      }
+      lock.unlock();
+      for (std::deque<Delivery>::const_iterator pDelivery = deliveries.begin();
+         pDelivery != deliveries.end(); ++pDelivery)
+      {
+         if (pDelivery->mpProgress != NULL)
+         {
+            pDelivery->mpProgress->updateProgress(pDelivery->mText, pDelivery->mPercent, NORMAL);
+         }
+         else
+         {
+            mpEngine->sendOutput(pDelivery->mText, pDelivery->mError, pDelivery->mpContext);
+         }
+      }
+      if (finished)
+      {
+         lock.relock();
+         mWaiting.erase(std::find(mWaiting.begin(), mWaiting.end(), pCaller));
+         break;
+      }
+      QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+      lock.relock();
+      if (!queued.mFinished && queued.mDeliveries.empty())
+      {
+         mUpdated.wait(&mMutex, EVENT_INTERVAL_MS);
+      }
+   }
+   return queued.mResult;
+}
+
+bool InterpreterThread::postOutput(const std::string& text, bool error, ScopedContext* pContext)
+{
+   Delivery delivery;
+   delivery.mText = text;
+   delivery.mError = error;
+   delivery.mpContext = pContext;
+   delivery.mpProgress = NULL;
+   delivery.mPercent = 0;
+   return post(delivery);
+}
+
+bool InterpreterThread::postProgress(ScopedContext* pContext, Progress* pProgress, const std::string& text,
+                                     int percent)
+{
+   Delivery delivery;
+   delivery.mText = text;
+   delivery.mError = false;
+   delivery.mpContext = pContext;
+   delivery.mpProgress = pProgress;
+   delivery.mPercent = percent;
+   return pContext != NULL && post(delivery);
+}
+
+bool InterpreterThread::post(const Delivery& delivery)
+{
+   QMutexLocker lock(&mMutex);
+   if (mpRunning == NULL || (delivery.mpContext != NULL && delivery.mpContext != mpRunning->mpContext))
+   {
+      return false;
+   }
+   mpRunning->mDeliveries.push_back(delivery);
+   mUpdated.wakeAll();
+   return true;
+}
+
+bool InterpreterThread::isWaiting()
+{
+   QMutexLocker lock(&mMutex);
+   return !mWaiting.empty();
+}
+
+void InterpreterThread::setCurrentContext(ScopedContext* pContext)
+{
+   QMutexLocker lock(&mMutex);
+   mpCurrentContext = pContext;
+}
+
+void InterpreterThread::run()
+{
+   // keep one thread state for the life of the thread and only hold the GIL while running a command
+   PyGILState_STATE gilState = PyGILState_Ensure();
+   const long threadId = PyThreadState_Get()->thread_id;
+   PyThreadState* pThreadState = PyEval_SaveThread();
+   QMutexLocker lock(&mMutex);
+   mThreadId = threadId;
+   for (;;)
+   {
+      while (mCommands.empty() && !mStop)
+      {
+         mQueued.wait(&mMutex);
+      }
+      if (mStop)
+      {
+         // commands which never ran fail
+         for (std::deque<Command*>::iterator pCommand = mCommands.begin(); pCommand != mCommands.end(); ++pCommand)
+         {
+            (*pCommand)->mFinished = true;
+         }
+         mCommands.clear();
+         mUpdated.wakeAll();
+         break;
+      }
+      Command* pCommand = mCommands.front();
+      mCommands.pop_front();
+      mpRunning = pCommand;
+      mpCurrentContext = pCommand->mpContext;
+      lock.unlock();
+
+      PyEval_RestoreThread(pThreadState);
+      bool result = mpEngine->runCommand(pCommand->mText, pCommand->mpContext);
+      pThreadState = PyEval_SaveThread();
+
+      lock.relock();
+      mpRunning = NULL;
+      mpCurrentContext = NULL;
+      pCommand->mResult = result;
+      pCommand->mFinished = true;
+      mUpdated.wakeAll();
+   }
+   lock.unlock();
+   PyEval_RestoreThread(pThreadState);
+   PyGILState_Release(gilState);
+}
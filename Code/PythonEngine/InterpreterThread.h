@@ -0,0 +1,131 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef INTERPRETERTHREAD_H
+#define INTERPRETERTHREAD_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+class Progress;
+class PythonEngine;
+class ScopedContext;
+
+/**
+ * Runs Python commands for the PythonEngine on a dedicated thread.
+ *
+ * Commands are queued and run in order. The thread holds the GIL only while a command is running.
+ * Output and progress from a command are queued on the command and delivered by the thread which
+ * called execute() while it waits, so they reach the command's slots and Progress before execute()
+ * returns and its caller releases them. Commands started by the running command are called from
+ * this thread, so their own slots and Progress are used directly instead. Text the running command
+ * has buffered for longer than the OutputStream time threshold is taken by the waiting caller.
+ *
+ * Scripts call the Opticks API from this thread and nothing is passed back to the main thread.
+ * Commands run this way must not create, change or destroy views, layers, widgets or other GUI
+ * objects. User input is held back while the main thread waits so the user can not change the
+ * session under the command.
+ */
+class InterpreterThread : public QThread
+{
+public:
+   InterpreterThread(PythonEngine* pEngine);
+   virtual ~InterpreterThread();
+
+   /**
+    * Run a command on the interpreter thread and wait for it to finish.
+    * The GIL must not be held by the caller. Events other than user input are processed while
+    * waiting so the application repaints and output is delivered as the command produces it.
+    * A command can not be started by an event processed while its thread waits. It fails and
+    * an error is sent to the context's error slot.
+    *
+    * @param command
+    *        The Python source to run.
+    * @param pContext
+    *        The context to run a scoped command in or NULL to pass the command to the interactive interpreter.
+    *
+    * @return True if the command ran without a Python exception.
+    */
+   bool execute(const std::string& command, ScopedContext* pContext);
+
+   /**
+    * Queue output from the interpreter thread for the caller of the running command.
+    *
+    * @param pContext
+    *        The context of the scoped command which wrote the text or NULL to only send the
+    *        text to the engine's signals.
+    *
+    * @return False if pContext is not the context of the running command. The text was not queued.
+    */
+   bool postOutput(const std::string& text, bool error, ScopedContext* pContext);
+
+   /**
+    * Queue an update of a Progress from the interpreter thread for the caller of the running command.
+    *
+    * @return False if pContext is not the context of the running command. The update was not queued.
+    */
+   bool postProgress(ScopedContext* pContext, Progress* pProgress, const std::string& text, int percent);
+
+   /**
+    * Record the context of the scoped command running on the interpreter thread, which changes
+    * while a command started by the running command runs. Its buffered text is only taken by the
+    * waiting caller while the running command's own context is current.
+    */
+   void setCurrentContext(ScopedContext* pContext);
+
+   /**
+    * Is a thread waiting in execute()? The engine must not be destroyed while one is.
+    */
+   bool isWaiting();
+
+protected:
+   virtual void run();
+
+private:
+   InterpreterThread(const InterpreterThread& rhs);
+   InterpreterThread& operator=(const InterpreterThread& rhs);
+
+   struct Delivery
+   {
+      std::string mText;
+      bool mError;
+      ScopedContext* mpContext;
+      Progress* mpProgress;   // progress is reported instead of output if this is not NULL
+      int mPercent;
+   };
+
+   struct Command
+   {
+      std::string mText;
+      ScopedContext* mpContext;
+      bool mFinished;
+      bool mResult;
+      std::deque<Delivery> mDeliveries;
+   };
+
+   bool post(const Delivery& delivery);
+
+   PythonEngine* mpEngine;
+   QMutex mMutex;
+   QWaitCondition mQueued;
+   QWaitCondition mUpdated;
+   std::deque<Command*> mCommands;
+   std::vector<QThread*> mWaiting;   // the threads waiting in execute()
+   Command* mpRunning;
+   ScopedContext* mpCurrentContext;
+   long mThreadId;   // the Python thread id of the interpreter thread
+   bool mStop;
+};
+
+#endif
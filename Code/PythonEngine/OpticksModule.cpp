@@ -7,11 +7,21 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "AoiMask.h"
+#include "BandStatistics.h"
+#include "DynamicObjectDict.h"
 #include "OpticksModule.h"
+#include "OutputStream.h"
 #include "PlugInRegistration.h"
+#include "PropertyCache.h"
 #include "PythonCommon.h"
 #include "PythonEngine.h"
 #include "PythonVersion.h"
+#include "RasterBuffer.h"
+#include "ScriptCache.h"
+#include "SimpleApiTable.h"
+#include "TileReader.h"
+#include "VariantArray.h"
 
 namespace OpticksModule
 {
@@ -32,6 +42,66 @@ namespace OpticksModule
                                           "This is used when initializing modules within a .pyd file."},
       {"pythonVersion", get_python_version, METH_NOARGS, "Retrieve the version of the Python plug-in as a string."},
       {"send_output", transmitOutput, METH_VARARGS, "Send output back to Opticks."},
+      {"progress", transmitProgress, METH_VARARGS,
+         "progress(message, percent=0) -> bool\n" \
+         "Report the progress of the running script. Returns False if the script has no progress to update."},
+      {"raster_buffer", RasterBuffer::raster_buffer, METH_VARARGS,
+         "raster_buffer(handle, row_start, row_end, column_start, column_end, band_start, band_end, interleave, " \
+         "row_step=1, column_step=1, band_step=1)\n" \
+         "Create a RasterBuffer for an inclusive sub-cube of a raster element."},
+      {"raster_write", RasterBuffer::raster_write, METH_VARARGS,
+         "raster_write(handle, row_start, row_end, column_start, column_end, band_start, band_end, interleave, " \
+         "data, row_step=1, column_step=1, band_step=1, format=None, scale=1.0, offset=0.0)\n" \
+         "Copy a C ordered buffer into an inclusive sub-cube of a raster element, converting items of format " \
+         "to the element's encoding if it is specified."},
+      {"raster_info", RasterBuffer::raster_info, METH_VARARGS,
+         "raster_info(handle) -> (rows, columns, bands, interleave, encoding, encoding_size)"},
+      {"tile_reader", TileReaderModule::tile_reader, METH_VARARGS,
+         "tile_reader(handle, tile_rows, tile_columns, interleave, band_start, band_end)\n" \
+         "Create an iterator which yields (row, column, RasterBuffer) for each tile of a raster element. " \
+         "The next tile is read on a worker thread while the current tile is processed."},
+      {"aoi_to_mask", AoiMask::aoi_to_mask, METH_VARARGS,
+         "aoi_to_mask(handle, min_column, min_row, max_column, max_row, packed) -> str\n" \
+         "Extract the selection state of an inclusive region of an AOI as a row major mask."},
+      {"aoi_set_mask", AoiMask::aoi_set_mask, METH_VARARGS,
+         "aoi_set_mask(handle, column, row, rows, columns, mask, packed)\n" \
+         "Select the AOI pixels which are set in a row major mask and deselect those which are clear."},
+      {"aoi_reduce", BandStatistics::aoi_reduce, METH_VARARGS,
+         "aoi_reduce(aoi_handle, raster_handle, bands, bins) -> list\n" \
+         "Calculate (count, mean, std, min, max, histogram) for each band over the pixels selected by an AOI."},
+      {"statistics_engine", BandStatistics::statistics_engine, METH_VARARGS,
+         "statistics_engine(handle, bands, bins, lower, upper, strip_rows) -> StatisticsEngine\n" \
+         "Create incrementally updated statistics of bands of a raster element, kept per strip of rows. " \
+         "Histograms cover lower to upper or each band's range if lower is greater than upper."},
+      {"native_value", VariantArray::native_value, METH_VARARGS,
+         "native_value(type_name, address, owner) -> value or None\n" \
+         "Convert a numeric value or vector, returning vectors as VariantArray views which keep owner alive."},
+      {"variant_from_array", VariantArray::variant_from_array, METH_VARARGS,
+         "variant_from_array(type_name, buffer) -> address\n" \
+         "Create a DataVariant from a buffer of native items. The caller owns the DataVariant."},
+      {"native_format", VariantArray::native_format, METH_VARARGS,
+         "native_format(type_name) -> format or None\n" \
+         "The struct format of a numeric type or of the items of a vector type."},
+      {"native_type_name", VariantArray::native_type_name, METH_VARARGS,
+         "native_type_name(format) -> type_name or None\n" \
+         "The DataVariant type name which stores items of a struct format."},
+      {"dynamic_object_to_dict", DynamicObjectDict::dynamic_object_to_dict, METH_VARARGS,
+         "dynamic_object_to_dict(handle, adopt) -> dict\n" \
+         "Copy a DynamicObject tree. adopt(address) wraps each new DataVariant which is not converted natively."},
+      {"dynamic_object_update", DynamicObjectDict::dynamic_object_update, METH_VARARGS,
+         "dynamic_object_update(handle, values, convert)\n" \
+         "Set DynamicObject attributes from a dict. convert(value) returns a DataVariant for other values."},
+      {"property_cache", PropertyCache::property_cache, METH_VARARGS,
+         "property_cache(handle, kind) -> dict\n" \
+         "The cached properties of a DataElement or Layer handle, emptied when the object is modified or deleted."},
+      {"set_error_source", SimpleApiTable::set_error_source, METH_VARARGS,
+         "set_error_source(get_last_error_address, exception_type)\n" \
+         "Register SimpleApiLib's getLastError() and the exception type raised by error_check."},
+      {"code_cache_info", ScriptCache::code_cache_info, METH_NOARGS,
+         "code_cache_info() -> (hits, misses, entries, capacity)\nReport the use of the compiled command cache."},
+      {"error_check", SimpleApiTable::error_check, METH_VARARGS,
+         "error_check(result, func, args) -> args\n" \
+         "A ctypes errcheck function which raises the registered exception if a SimpleApiLib call failed."},
       {NULL, NULL, 0, NULL} // sentinel
    };
 } // namespace
@@ -43,4 +113,9 @@ PyMODINIT_FUNC init_opticks()
    {
       return;
    }
+   RasterBuffer::registerType(pModule);
+   TileReaderModule::registerType(pModule);
+   BandStatistics::registerType(pModule);
+   OutputStream::registerType(pModule);
+   VariantArray::registerType(pModule);
 }
@@ -0,0 +1,310 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "OutputStream.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QTime>
+
+#include <map>
+#include <structmember.h>
+
+namespace
+{
+   // deliver buffered text once it reaches this size
+   const std::string::size_type FLUSH_BYTES = 16 * 1024;
+
+   // or once the oldest buffered text is this old
+   const int FLUSH_MS = 100;
+
+   OutputStream::Sink spSink = NULL;
+   OutputStream::Owned spOwned = NULL;
+
+   struct Pending
+   {
+      std::string mText;
+      bool mError;
+      QTime mAge;
+   };
+
+   // text is buffered per thread so commands running on different threads are not mixed together
+   std::map<long, Pending> sPending;
+   QMutex sPendingMutex;
+
+   long currentThread()
+   {
+      return PyThreadState_Get()->thread_id;
+   }
+
+   // remove a buffer with sPendingMutex held, the text is sent after the mutex is released
+   void take(std::map<long, Pending>::iterator pPending, std::string& text, bool& error)
+   {
+      text.swap(pPending->second.mText);
+      error = pPending->second.mError;
+      sPending.erase(pPending);
+   }
+
+   void send(const std::string& text, bool error)
+   {
+      if (spSink != NULL && !text.empty())
+      {
+         spSink(text, error);
+      }
+   }
+
+   struct OutputStreamObject
+   {
+      PyObject_HEAD
+      int mError;
+      int mSoftSpace;   // used by the print statement
+   };
+
+   void append(const char* pText, Py_ssize_t length, bool error)
+   {
+      if (length == 0)
+      {
+         return;
+      }
+      const long thread = currentThread();
+      QMutexLocker lock(&sPendingMutex);
+      std::map<long, Pending>::iterator pPending = sPending.find(thread);
+      if (pPending != sPending.end() && pPending->second.mError != error)
+      {
+         lock.unlock();
+         OutputStream::flush();
+         lock.relock();
+         pPending = sPending.find(thread);
+      }
+      if (pPending == sPending.end())
+      {
+         pPending = sPending.insert(std::make_pair(thread, Pending())).first;
+         pPending->second.mText.reserve(FLUSH_BYTES);
+         pPending->second.mError = error;
+         pPending->second.mAge.start();
+      }
+      pPending->second.mText.append(pText, length);
+      if (pPending->second.mText.size() >= FLUSH_BYTES || pPending->second.mAge.elapsed() >= FLUSH_MS)
+      {
+         lock.unlock();
+         OutputStream::flush();
+      }
+   }
+
+   PyObject* outputStreamWrite(OutputStreamObject* pSelf, PyObject* pArgs)
+   {
+      const char* pText = NULL;
+      Py_ssize_t length = 0;
+      if (!PyArg_ParseTuple(pArgs, "s#", &pText, &length))
+      {
+         return NULL;
+      }
+      append(pText, length, pSelf->mError != 0);
+      Py_RETURN_NONE;
+   }
+
+   PyObject* outputStreamWriteLines(OutputStreamObject* pSelf, PyObject* pLines)
+   {
+      auto_obj iter(PyObject_GetIter(pLines), true);
+      if (iter.get() == NULL)
+      {
+         return NULL;
+      }
+      for (auto_obj line(PyIter_Next(iter), true); line.get() != NULL; line.reset(PyIter_Next(iter), true))
+      {
+         char* pText = NULL;
+         Py_ssize_t length = 0;
+         if (PyString_AsStringAndSize(line, &pText, &length) != 0)
+         {
+            return NULL;
+         }
+         append(pText, length, pSelf->mError != 0);
+      }
+      if (PyErr_Occurred())
+      {
+         return NULL;
+      }
+      Py_RETURN_NONE;
+   }
+
+   PyObject* outputStreamFlush(OutputStreamObject*, PyObject*)
+   {
+      OutputStream::flushAll();
+      Py_RETURN_NONE;
+   }
+
+   PyObject* outputStreamBuffered(OutputStreamObject*, PyObject*)
+   {
+      std::string::size_type length = 0;
+      QMutexLocker lock(&sPendingMutex);
+      for (std::map<long, Pending>::const_iterator pPending = sPending.begin(); pPending != sPending.end(); ++pPending)
+      {
+         length += pPending->second.mText.size();
+      }
+      return PyInt_FromSize_t(length);
+   }
+
+   PyObject* outputStreamIsATty(OutputStreamObject*, PyObject*)
+   {
+      Py_RETURN_FALSE;
+   }
+
+   int outputStreamInit(OutputStreamObject* pSelf, PyObject* pArgs, PyObject*)
+   {
+      int error = 0;
+      if (!PyArg_ParseTuple(pArgs, "|i", &error))
+      {
+         return -1;
+      }
+      pSelf->mError = error;
+      pSelf->mSoftSpace = 0;
+      return 0;
+   }
+
+   PyMethodDef sOutputStreamMethods[] = {
+      {"write", reinterpret_cast<PyCFunction>(outputStreamWrite), METH_VARARGS, "write(str)\nBuffer text for Opticks."},
+      {"writelines", reinterpret_cast<PyCFunction>(outputStreamWriteLines), METH_O,
+         "writelines(sequence)\nBuffer each string in a sequence for Opticks."},
+      {"flush", reinterpret_cast<PyCFunction>(outputStreamFlush), METH_NOARGS,
+         "Send text buffered by this thread and by threads which are not running a command to Opticks."},
+      {"buffered", reinterpret_cast<PyCFunction>(outputStreamBuffered), METH_NOARGS,
+         "buffered() -> int\nThe number of characters from every thread which have not been sent to Opticks."},
+      {"isatty", reinterpret_cast<PyCFunction>(outputStreamIsATty), METH_NOARGS, "Always False."},
+      {NULL, NULL, 0, NULL} // sentinel
+   };
+
+   PyMemberDef sOutputStreamMembers[] = {
+      {const_cast<char*>("softspace"), T_INT, offsetof(OutputStreamObject, mSoftSpace), 0,
+         const_cast<char*>("Used by the print statement.")},
+      {const_cast<char*>("is_error_stream"), T_INT, offsetof(OutputStreamObject, mError), READONLY,
+         const_cast<char*>("True if text is sent to Opticks as error text.")},
+      {NULL, 0, 0, 0, NULL} // sentinel
+   };
+
+   PyTypeObject sOutputStreamType = {
+      PyObject_HEAD_INIT(NULL)
+      0,                                                 // ob_size
+      "_opticks.OutputStream",                           // tp_name
+      sizeof(OutputStreamObject),                        // tp_basicsize
+      0,                                                 // tp_itemsize
+      0,                                                 // tp_dealloc
+      0,                                                 // tp_print
+      0,                                                 // tp_getattr
+      0,                                                 // tp_setattr
+      0,                                                 // tp_compare
+      0,                                                 // tp_repr
+      0,                                                 // tp_as_number
+      0,                                                 // tp_as_sequence
+      0,                                                 // tp_as_mapping
+      0,                                                 // tp_hash
+      0,                                                 // tp_call
+      0,                                                 // tp_str
+      0,                                                 // tp_getattro
+      0,                                                 // tp_setattro
+      0,                                                 // tp_as_buffer
+      Py_TPFLAGS_DEFAULT,                                // tp_flags
+      "OutputStream(is_error_stream=0)\nA buffered file-like object which sends text to Opticks.", // tp_doc
+      0,                                                 // tp_traverse
+      0,                                                 // tp_clear
+      0,                                                 // tp_richcompare
+      0,                                                 // tp_weaklistoffset
+      0,                                                 // tp_iter
+      0,                                                 // tp_iternext
+      sOutputStreamMethods,                              // tp_methods
+      sOutputStreamMembers,                              // tp_members
+      0,                                                 // tp_getset
+      0,                                                 // tp_base
+      0,                                                 // tp_dict
+      0,                                                 // tp_descr_get
+      0,                                                 // tp_descr_set
+      0,                                                 // tp_dictoffset
+      reinterpret_cast<initproc>(outputStreamInit)       // tp_init
+   };
+}
+
+namespace OutputStream
+{
+   bool registerType(PyObject* pModule)
+   {
+      sOutputStreamType.tp_new = PyType_GenericNew;
+      if (PyType_Ready(&sOutputStreamType) < 0)
+      {
+         return false;
+      }
+      Py_INCREF(&sOutputStreamType);
+      return PyModule_AddObject(pModule, "OutputStream", reinterpret_cast<PyObject*>(&sOutputStreamType)) == 0;
+   }
+
+   void setSink(Sink pSink)
+   {
+      spSink = pSink;
+   }
+
+   void setOwnerCheck(Owned pOwned)
+   {
+      spOwned = pOwned;
+   }
+
+   void flush()
+   {
+      const long thread = currentThread();
+      std::string text;
+      bool error = false;
+      {
+         QMutexLocker lock(&sPendingMutex);
+         std::map<long, Pending>::iterator pPending = sPending.find(thread);
+         if (pPending == sPending.end())
+         {
+            return;
+         }
+         take(pPending, text, error);
+      }
+      // the sink may write more text so the buffer is removed first
+      send(text, error);
+   }
+
+   void flushAll()
+   {
+      flush();
+      const long thread = currentThread();
+      for (;;)
+      {
+         std::string text;
+         bool error = false;
+         {
+            QMutexLocker lock(&sPendingMutex);
+            // another command's text goes to its own caller when that command flushes
+            std::map<long, Pending>::iterator pPending = sPending.begin();
+            while (pPending != sPending.end() &&
+               (pPending->first == thread || (spOwned != NULL && spOwned(pPending->first))))
+            {
+               ++pPending;
+            }
+            if (pPending == sPending.end())
+            {
+               return;
+            }
+            take(pPending, text, error);
+         }
+         send(text, error);
+      }
+   }
+
+   bool takeStale(long threadId, std::string& text, bool& error)
+   {
+      QMutexLocker lock(&sPendingMutex);
+      std::map<long, Pending>::iterator pPending = sPending.find(threadId);
+      if (pPending == sPending.end() || pPending->second.mAge.elapsed() < FLUSH_MS)
+      {
+         return false;
+      }
+      take(pPending, text, error);
+      return true;
+   }
+}
@@ -0,0 +1,76 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef OUTPUTSTREAM_H
+#define OUTPUTSTREAM_H
+
+#include "PythonCommon.h"
+
+#include <string>
+
+/**
+ * Buffered replacements for sys.stdout and sys.stderr.
+ *
+ * Both streams share one buffer per thread so the relative order of output and error text is kept
+ * and output from commands running on different threads is not mixed.
+ * Text is delivered to the output sink when the buffer reaches a size threshold, when it has
+ * held text for longer than a time threshold, when the other stream is written or when it is
+ * flushed explicitly. Text left by threads which are not running a command, such as threading.Thread
+ * workers, is delivered when a command ends.
+ * The buffers are guarded by their own mutex so text which has waited too long can be taken
+ * by another thread without the GIL.
+ */
+namespace OutputStream
+{
+   typedef void (*Sink)(const std::string& text, bool error);
+   typedef bool (*Owned)(long threadId);
+
+   /**
+    * Add the OutputStream type to a module.
+    *
+    * @return True on success, false if a Python exception has been set.
+    */
+   bool registerType(PyObject* pModule);
+
+   /**
+    * Set the function which receives buffered text.
+    */
+   void setSink(Sink pSink);
+
+   /**
+    * Set the function which reports whether a thread is running a command. The text buffered by such
+    * a thread is only delivered by the thread itself. The function is called with the GIL held.
+    */
+   void setOwnerCheck(Owned pOwned);
+
+   /**
+    * Deliver any text buffered by the calling thread to the sink. The GIL must be held.
+    */
+   void flush();
+
+   /**
+    * Deliver the text buffered by the calling thread and then any text left by other threads which
+    * are not running a command, such as threading.Thread workers, to the sink. The other threads' text
+    * is sent as if the calling thread wrote it. The GIL must be held.
+    */
+   void flushAll();
+
+   /**
+    * Remove the text buffered by a thread if it has been held longer than the time threshold.
+    * The GIL is not needed so a thread waiting for a command can deliver its output while it runs.
+    *
+    * @param threadId
+    *        The Python thread id of the writer.
+    *
+    * @return True if text was taken.
+    */
+   bool takeStale(long threadId, std::string& text, bool& error);
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DataElement.h"
+#include "Layer.h"
+#include "PropertyCache.h"
+#include "Slot.h"
+#include "Subject.h"
+
+#include <QtCore/QAtomicInt>
+#include <algorithm>
+#include <map>
+#include <string>
+
+namespace
+{
+   class CacheEntry
+   {
+   public:
+      CacheEntry() :
+         mpSubject(NULL),
+         mpProperties(NULL),
+         mStale(0),
+         mDeleted(0)
+      {
+      }
+
+      ~CacheEntry()
+      {
+         if (mpSubject != NULL && mDeleted.fetchAndStoreOrdered(1) == 0)
+         {
+            mpSubject->detach(SIGNAL_NAME(Subject, Modified), Slot(this, &CacheEntry::modified));
+            mpSubject->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &CacheEntry::deleted));
+         }
+         Py_XDECREF(mpProperties);
+      }
+
+      /**
+       * Get the properties of a subject, emptying them if it has changed since the last call.
+       *
+       * @return A borrowed reference or NULL if a Python exception has been set.
+       */
+      PyObject* getProperties(Subject* pSubject)
+      {
+         if (mDeleted.fetchAndStoreOrdered(0) != 0)
+         {
+            // the handle has been reused by a new object
+            mpSubject = NULL;
+         }
+         if (mpSubject == NULL)
+         {
+            mpSubject = pSubject;
+            mpSubject->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &CacheEntry::modified));
+            mpSubject->attach(SIGNAL_NAME(Subject, Deleted), Slot(this, &CacheEntry::deleted));
+         }
+         if (mpProperties == NULL)
+         {
+            mpProperties = PyDict_New();
+         }
+         else if (mStale.fetchAndStoreOrdered(0) != 0)
+         {
+            PyDict_Clear(mpProperties);
+         }
+         return mpProperties;
+      }
+
+      bool isDeleted() const
+      {
+         return mDeleted != 0;
+      }
+
+      void modified(Subject& subject, const std::string& signal, const boost::any& data)
+      {
+         mStale.fetchAndStoreOrdered(1);
+      }
+
+      void deleted(Subject& subject, const std::string& signal, const boost::any& data)
+      {
+         mStale.fetchAndStoreOrdered(1);
+         mDeleted.fetchAndStoreOrdered(1);
+      }
+
+   private:
+      Subject* mpSubject;
+      PyObject* mpProperties;
+      QAtomicInt mStale;
+      QAtomicInt mDeleted;
+   };
+
+   typedef std::map<void*, CacheEntry*> CacheEntryMap;
+   CacheEntryMap sEntries;
+   CacheEntryMap::size_type sSweepSize = 256;
+
+   // drop the entries of deleted objects whose handles have not been reused
+   void sweep()
+   {
+      for (CacheEntryMap::iterator pEntry = sEntries.begin(); pEntry != sEntries.end();)
+      {
+         if (pEntry->second->isDeleted())
+         {
+            delete pEntry->second;
+            sEntries.erase(pEntry++);
+         }
+         else
+         {
+            ++pEntry;
+         }
+      }
+      sSweepSize = std::max<CacheEntryMap::size_type>(256, sEntries.size() * 2);
+   }
+}
+
+namespace PropertyCache
+{
+   PyObject* property_cache(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      const char* pKind = NULL;
+      if (!PyArg_ParseTuple(pArgs, "Os", &pHandle, &pKind))
+      {
+         return NULL;
+      }
+      void* pAddress = (pHandle == Py_None) ? NULL : PyLong_AsVoidPtr(pHandle);
+      if (pAddress == NULL)
+      {
+         if (!PyErr_Occurred())
+         {
+            PyErr_SetString(PyExc_ValueError, "Invalid handle.");
+         }
+         return NULL;
+      }
+      Subject* pSubject = NULL;
+      const std::string kind(pKind);
+      if (kind == "DataElement")
+      {
+         pSubject = reinterpret_cast<DataElement*>(pAddress);
+      }
+      else if (kind == "Layer")
+      {
+         pSubject = reinterpret_cast<Layer*>(pAddress);
+      }
+      else
+      {
+         PyErr_SetString(PyExc_ValueError, "The kind must be \"DataElement\" or \"Layer\".");
+         return NULL;
+      }
+
+      CacheEntryMap::iterator pEntry = sEntries.find(pAddress);
+      if (pEntry == sEntries.end())
+      {
+         if (sEntries.size() >= sSweepSize)
+         {
+            sweep();
+         }
+         pEntry = sEntries.insert(std::make_pair(pAddress, new CacheEntry)).first;
+      }
+      PyObject* pProperties = pEntry->second->getProperties(pSubject);
+      Py_XINCREF(pProperties);
+      return pProperties;
+   }
+
+   void clear()
+   {
+      for (CacheEntryMap::iterator pEntry = sEntries.begin(); pEntry != sEntries.end(); ++pEntry)
+      {
+         delete pEntry->second;
+      }
+      sEntries.clear();
+   }
+}
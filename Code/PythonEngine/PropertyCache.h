@@ -0,0 +1,39 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef PROPERTYCACHE_H
+#define PROPERTYCACHE_H
+
+#include "PythonCommon.h"
+
+/**
+ * Per handle caches of DataElement and Layer properties for the opticks package.
+ *
+ * Each handle has a dict which the package fills with properties such as the name, type
+ * and DataInfo of the object. The cache attaches to the object's Subject::Modified and
+ * Subject::Deleted signals and the dict is emptied the next time it is requested after
+ * either is sent. The signals may arrive on any thread, so they only mark the entry and
+ * the dict itself is only used with the GIL held.
+ */
+namespace PropertyCache
+{
+   /**
+    * property_cache(handle, kind) -> dict
+    *
+    * Get the property cache of a handle. kind is "DataElement" or "Layer".
+    */
+   PyObject* property_cache(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * Detach from all cached objects and release the dicts. The caller must hold the GIL.
+    */
+   void clear();
+}
+
+#endif
@@ -7,22 +7,64 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "AbortMonitor.h"
 #include "AppVerify.h"
-#include "AttachmentPtr.h"
-#include "FileResource.h"
+#include "InterpreterThread.h"
 #include "MessageLogResource.h"
 #include "OpticksModule.h"
+#include "OutputStream.h"
 #include "PythonEngine.h"
 #include "PythonVersion.h"
 #include "PlugInRegistration.h"
+#include "Progress.h"
+#include "PropertyCache.h"
 #include "PythonCommon.h"
+#include "ScopedContext.h"
+#include "ScriptCache.h"
 #include <sstream>
 
 #include <boost/tokenizer.hpp>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QTime>
 
 namespace
 {
    PythonEngine* spEngine = NULL;
+
+   // warm scoped contexts kept for reuse
+   const std::vector<ScopedContext*>::size_type MAX_IDLE_CONTEXTS = 8;
+
+   void deliverBufferedOutput(const std::string& text, bool error)
+   {
+      if (spEngine != NULL)
+      {
+         spEngine->deliverOutput(text, error);
+      }
+   }
+
+   bool isBufferOwned(long threadId)
+   {
+      return spEngine != NULL && spEngine->isRunningCommand(threadId);
+   }
+
+   // a new reference to None or the address as a Python integer
+   PyObject* addressOf(void* pObject)
+   {
+      if (pObject == NULL)
+      {
+         Py_RETURN_NONE;
+      }
+      return PyLong_FromVoidPtr(pObject);
+   }
+
+   void addTiming(std::string& timings, const char* pPhase, int milliseconds)
+   {
+      std::ostringstream stream;
+      stream << (timings.empty() ? "Startup: " : ", ") << pPhase << " " << milliseconds << " ms";
+      timings += stream.str();
+   }
 };
 
 PyObject* transmitOutput(PyObject* pSelf, PyObject* pArgs)
@@ -52,6 +94,21 @@ PyObject* transmitOutput(PyObject* pSelf, PyObject* pArgs)
    Py_RETURN_NONE;
 }
 
+PyObject* transmitProgress(PyObject* pSelf, PyObject* pArgs)
+{
+   const char* pText = NULL;
+   int percent = 0;
+   if (!PyArg_ParseTuple(pArgs, "s|i", &pText, &percent))
+   {
+      return NULL;
+   }
+   if (spEngine != NULL && spEngine->sendProgress(pText, percent))
+   {
+      Py_RETURN_TRUE;
+   }
+   Py_RETURN_FALSE;
+}
+
 extern "C" LINKAGE PythonInterpreter* init_python_engine(External* pExternal)
 {
    if (pExternal == NULL)
@@ -77,18 +134,36 @@ extern "C" LINKAGE void shutdown_python_engine()
    spEngine = NULL;
 }
 
+extern "C" LINKAGE bool python_engine_busy()
+{
+   return spEngine != NULL && spEngine->isExecuting();
+}
+
 PythonEngine::PythonEngine()
    : mPrompt(">>> "), mGlobalOutputShown(false), mPythonRunning(false),
-   mAttemptedOneStart(false), mRunningScopedCommand(false)
+   mAttemptedOneStart(false), mInitializeFailed(false), mImportFailed(false), mUserFileRun(false),
+   mStartupMs(0), mGatheringOutput(false), mpMainThreadState(NULL), mpInterpreterThread(NULL)
 {
 }
 
 PythonEngine::~PythonEngine()
 {
+   delete mpInterpreterThread;
+   if (mpMainThreadState != NULL)
+   {
+      PyEval_RestoreThread(mpMainThreadState);
+   }
    if (mRunModule.get() != NULL)
    {
+      for (std::vector<ScopedContext*>::iterator pContext = mIdleContexts.begin();
+         pContext != mIdleContexts.end(); ++pContext)
+      {
+         delete *pContext;
+      }
+      mIdleContexts.clear();
+      ScriptCache::clear();
+      PropertyCache::clear();
       mInterpModule.reset(NULL);
-      mStdin.reset(NULL);
       mInterpreter.reset(NULL);
       mGlobals.reset(NULL);
       mRunModule.reset(NULL);
@@ -101,18 +176,24 @@ bool PythonEngine::isPythonRunning() const
    return mPythonRunning;
 }
 
-bool PythonEngine::startPython()
+bool PythonEngine::isExecuting()
+{
+   QMutexLocker lock(&mContextMutex);
+   return mpInterpreterThread != NULL && mpInterpreterThread->isWaiting();
+}
+
+bool PythonEngine::initializePython()
 {
-   if (mPythonRunning)
-   {
-      return true;
-   }
    if (mAttemptedOneStart)
    {
-      return false;
+      return !mInitializeFailed;
    }
    mAttemptedOneStart = true;
    mStartupMessage.clear();
+   mStartupTimings.clear();
+   mStartupMs = 0;
+   QTime phaseTimer;
+   phaseTimer.start();
    try
    {
       std::string pythonHome = PythonInterpreter::getSettingPythonHome();
@@ -122,6 +203,7 @@ bool PythonEngine::startPython()
       }
       Py_SetProgramName("opticks");
       Py_Initialize();
+      PyEval_InitThreads();
 
       mRunModule.reset(PyModule_New("__opticks_script__"), true);
       checkErr();
@@ -134,39 +216,64 @@ bool PythonEngine::startPython()
 
       init_opticks();
       checkErr();
+      OutputStream::setSink(deliverBufferedOutput);
+      OutputStream::setOwnerCheck(isBufferOwned);
       auto_obj sysPath(PySys_GetObject("path"));
       std::string newPath =
          Service<ConfigurationSettings>()->getSettingSupportFilesPath()->getFullPathAndName() + "/site-packages";
       auto_obj newPathItem(PyString_FromString(newPath.c_str()), true);
       VERIFYNR(PyList_Append(sysPath, newPathItem) == 0);
       VERIFYNR(PySys_SetObject("path", sysPath) == 0);
+   }
+   catch(const PythonError& err)
+   {
+      mStartupMessage = "Error initializing python engine.\n" + std::string(err.what());
+      MessageResource msg("Error initializing python engine.", "python", "{d32b0337-63f2-43fc-8d82-0387a9b5d254}");
+      msg->addProperty("Err", err.what());
+      mInitializeFailed = true;
+   }
+   const int elapsed = phaseTimer.elapsed();
+   addTiming(mStartupTimings, "initialize", elapsed);
+   mStartupMs += elapsed;
+
+   // this thread keeps the main thread state, the engine is finalized from it
+   // release the GIL so other threads can run Python, it is reacquired with GilLock when needed
+   mpMainThreadState = PyEval_SaveThread();
+   return !mInitializeFailed;
+}
+
+bool PythonEngine::importInterpreter()
+{
+   if (mInterpreter.get() != NULL)
+   {
+      return true;
+   }
+   if (!initializePython() || mImportFailed)
+   {
+      return false;
+   }
+   QTime phaseTimer;
+   phaseTimer.start();
+   GilLock lock;
+   try
+   {
       mInterpModule.reset(PyImport_ImportModule("interpreter"), true);
       checkErr();
       auto_obj interpDict(PyModule_GetDict(mInterpModule));
       checkErr();
-      
-      auto_obj strBufStream(PyDict_GetItemString(interpDict, "StrBufStream"));
-      checkErr();
-      mStdin.reset(PyObject_CallObject(strBufStream, NULL), true);
-      checkErr();
-      VERIFYNR(mStdin.get());
 
       auto_obj pythonInteractiveInterpreter(PyDict_GetItemString(interpDict, "PythonInteractiveInterpreter"));
       mInterpreter.reset(PyObject_CallObject(pythonInteractiveInterpreter, Py_BuildValue("(O)", mGlobals.get())), true);
       checkErr();
 
-      PyObject_SetAttrString(mInterpreter, "stdin", mStdin);
-      checkErr();
-      mStartupMessage = "Python ";
-      mStartupMessage += Py_GetVersion();
-      mStartupMessage += " on ";
-      mStartupMessage += Py_GetPlatform();
-      mStartupMessage += "\nType \"help(opticks)\" for release notes.\n";
       auto_obj builtinModule(PyImport_Import(PyString_FromString("__builtin__")), true);
       checkErr();
-      auto_obj opticksModule(PyImport_Import(PyString_FromString("opticks")), true);
+
+      // the opticks package, its bindings and numpy are imported the first time the proxy is used
+      auto_obj lazyModule(PyDict_GetItemString(interpDict, "LazyModule"));
+      auto_obj opticksModule(PyObject_CallFunction(lazyModule, "s", "opticks"), true);
       checkErr();
-      PyModule_AddObject(builtinModule, "opticks", opticksModule.release());
+      PyObject_SetAttrString(builtinModule, "opticks", opticksModule);
       checkErr();
    }
    catch(const PythonError& err)
@@ -174,51 +281,84 @@ bool PythonEngine::startPython()
       mStartupMessage = "Error initializing python engine.\n" + std::string(err.what());
       MessageResource msg("Error initializing python engine.", "python", "{d32b0337-63f2-43fc-8d82-0387a9b5d254}");
       msg->addProperty("Err", err.what());
+      mInterpreter.reset(NULL);
+      mImportFailed = true;
       return false;
    }
+   const int elapsed = phaseTimer.elapsed();
+   addTiming(mStartupTimings, "interpreter", elapsed);
+   mStartupMs += elapsed;
+   return true;
+}
 
+bool PythonEngine::runUserFile()
+{
+   if (mUserFileRun)
+   {
+      return true;
+   }
+   if (!importInterpreter())
+   {
+      return false;
+   }
+   mUserFileRun = true;
+   QTime phaseTimer;
+   phaseTimer.start();
+
+   // this may be a worker thread, so the output is kept for the startup message and not sent to observers
+   GilLock lock;
    std::string userFileName;
-   std::string errorMsg;
+   mGatheredOutput.clear();
+   mGatheringOutput = true;
    try
    {
-      mGatheredOutput.clear();
-      AttachmentPtr<PythonEngine> attachments(this);
-      attachments.addSignal(SIGNAL_NAME(Interpreter, OutputText), Slot(this, &PythonEngine::gatherOutput));
-      attachments.addSignal(SIGNAL_NAME(Interpreter, ErrorText), Slot(this, &PythonEngine::gatherOutput));
       const Filename* pUserFile = PythonInterpreter::getSettingUserFile();
       userFileName = (pUserFile == NULL) ? "" : pUserFile->getFullPathAndName();
-      FileResource userFile(userFileName.c_str(), "r");
-      if (userFile.get() != NULL)
+      if (!userFileName.empty() && QFileInfo(QString::fromStdString(userFileName)).isFile())
       {
-         const unsigned int BUF_SIZE = 4096;
-         char pBuf[BUF_SIZE];
-         std::string allFileContents;
-         while (!feof(userFile))
-         {
-            size_t readSize = fread(pBuf, sizeof(char), BUF_SIZE, userFile);
-            if (ferror(userFile) || readSize == 0)
-            {
-               throw PythonError("Invalid user file!");
-            }
-            allFileContents = allFileContents + std::string(pBuf, readSize);
-         }
-         PyRun_String(allFileContents.c_str(), Py_file_input, mGlobals.get(), mGlobals.get());
+         auto_obj code(ScriptCache::compileFile(userFileName), true);
+         checkErr();
+         auto_obj result(PyEval_EvalCode(reinterpret_cast<PyCodeObject*>(code.get()), mGlobals, mGlobals), true);
          checkErr();
       }
+      OutputStream::flushAll();
    }
    catch(const PythonError& err)
    {
-      errorMsg = "Error executing user python file at: " + userFileName + ".\n" + std::string(err.what());
+      OutputStream::flushAll();
+      mGatheredOutput += "Error executing user python file at: " + userFileName + ".\n" + std::string(err.what());
    }
-   if (!mGatheredOutput.empty())
+   mGatheringOutput = false;
+   const int elapsed = phaseTimer.elapsed();
+   addTiming(mStartupTimings, "user file", elapsed);
+   mStartupMs += elapsed;
+   return true;
+}
+
+bool PythonEngine::startPython()
+{
+   if (mPythonRunning)
    {
-      mStartupMessage += mGatheredOutput;
-      mGatheredOutput.clear();
+      return true;
    }
-   if (!errorMsg.empty())
+   if (!runUserFile())
+   {
+      return false;
+   }
+
+   mStartupMessage = "Python ";
+   mStartupMessage += Py_GetVersion();
+   mStartupMessage += " on ";
+   mStartupMessage += Py_GetPlatform();
+   mStartupMessage += "\nType \"help(opticks)\" for release notes.\n";
+   mStartupMessage += mGatheredOutput;
+   mGatheredOutput.clear();
+   addTiming(mStartupTimings, "total", mStartupMs);
+   if (!mStartupMessage.empty() && mStartupMessage[mStartupMessage.size() - 1] != '\n')
    {
-      mStartupMessage += errorMsg;
+      mStartupMessage += "\n";
    }
+   mStartupMessage += mStartupTimings + "\n";
 
    if (!PythonInterpreter::getSettingInteractiveAvailable())
    {
@@ -246,8 +386,131 @@ bool PythonEngine::executeCommand(const std::string& command)
    {
       return false;
    }
+   InterpreterThread* pThread = getInterpreterThread();
+   if (pThread != NULL)
+   {
+      return pThread->execute(command, NULL);
+   }
+   return runCommand(command, NULL);
+}
+
+bool PythonEngine::executeScopedCommand(const std::string& command, const Slot& output,
+                                        const Slot& error, Progress* pProgress)
+{
+   if (!mPythonRunning)
+   {
+      return false;
+   }
+   ScopedContext* pContext = acquireContext(output, error, pProgress);
+   bool retVal = false;
+   InterpreterThread* pThread = getInterpreterThread();
+   if (pThread != NULL)
+   {
+      retVal = pThread->execute(command, pContext);
+   }
+   else
+   {
+      retVal = runCommand(command, pContext);
+   }
+   releaseContext(pContext);
+   return retVal;
+}
+
+bool PythonEngine::executeScript(const std::string& filename, PlugInArgList* pInArgList,
+                                 PlugInArgList* pOutArgList, DynamicObject* pResults, const Slot& output,
+                                 const Slot& error, Progress* pProgress)
+{
+   if (!mPythonRunning)
+   {
+      return false;
+   }
+   ScopedContext* pContext = acquireContext(output, error, pProgress);
+   pContext->setScript(filename, pInArgList, pOutArgList, pResults);
+   bool retVal = false;
+   InterpreterThread* pThread = getInterpreterThread();
+   if (pThread != NULL)
+   {
+      retVal = pThread->execute(std::string(), pContext);
+   }
+   else
+   {
+      retVal = runCommand(std::string(), pContext);
+   }
+   releaseContext(pContext);
+   return retVal;
+}
+
+InterpreterThread* PythonEngine::getInterpreterThread()
+{
+   if (!PythonInterpreter::getSettingBackgroundExecution())
+   {
+      return NULL;
+   }
+   QMutexLocker lock(&mContextMutex);
+   if (mpInterpreterThread == NULL)
+   {
+      mpInterpreterThread = new InterpreterThread(this);
+      mpInterpreterThread->start();
+   }
+   // commands started by a running command, such as a plug-in executing another script, run immediately
+   if (QThread::currentThread() == mpInterpreterThread)
+   {
+      return NULL;
+   }
+   return mpInterpreterThread;
+}
+
+bool PythonEngine::runCommand(const std::string& command, ScopedContext* pContext)
+{
+   GilLock lock;
+   return pContext != NULL ? runScopedCommand(command, pContext) : runInteractiveCommand(command);
+}
+
+ScopedContext* PythonEngine::acquireContext(const Slot& output, const Slot& error, Progress* pProgress)
+{
+   ScopedContext* pContext = NULL;
+   mContextMutex.lock();
+   if (!mIdleContexts.empty())
+   {
+      pContext = mIdleContexts.back();
+      mIdleContexts.pop_back();
+   }
+   mContextMutex.unlock();
+   if (pContext == NULL)
+   {
+      pContext = new ScopedContext();
+   }
+   pContext->setTarget(output, error, pProgress);
+   return pContext;
+}
+
+void PythonEngine::releaseContext(ScopedContext* pContext)
+{
+   pContext->setTarget(Slot(), Slot(), NULL);
+   pContext->setScript(std::string(), NULL, NULL, NULL);
+   QMutexLocker lock(&mContextMutex);
+   if (mIdleContexts.size() < MAX_IDLE_CONTEXTS)
+   {
+      mIdleContexts.push_back(pContext);
+      return;
+   }
+   lock.unlock();
+   GilLock gil;
+   delete pContext;
+}
+
+ScopedContext* PythonEngine::getCurrentContext() const
+{
+   std::map<long, ScopedContext*>::const_iterator pContext = mThreadContexts.find(PyThreadState_Get()->thread_id);
+   return pContext == mThreadContexts.end() ? NULL : pContext->second;
+}
+
+bool PythonEngine::runInteractiveCommand(const std::string& command)
+{
    bool retVal = true;
-   mRunningScopedCommand = false;
+   // the command's buffered text is not taken by scoped commands running on other threads
+   const long threadId = PyThreadState_Get()->thread_id;
+   const bool owned = mThreadContexts.insert(std::make_pair(threadId, static_cast<ScopedContext*>(NULL))).second;
    try
    {
       std::string::size_type commandLen = command.size();
@@ -255,44 +518,89 @@ bool PythonEngine::executeCommand(const std::string& command)
       {
          commandLen--;
       }
-      auto_obj cnt(PyObject_CallMethod(mStdin, "write", "sl", command.c_str(), commandLen), true);
-      checkErr();
-      auto_obj useps1(PyObject_CallMethod(mInterpreter, "process_event", NULL), true);
-      checkErr();
-      if (useps1 == Py_True)
+      std::string::size_type lineStart = 0;
+      std::string::size_type lineEnd = command.find('\n');
+      while (lineEnd < commandLen)
       {
-         mPrompt = ">>> ";
+         mInput.addLine(command.substr(lineStart, lineEnd - lineStart));
+         lineStart = lineEnd + 1;
+         lineEnd = command.find('\n', lineStart);
       }
-      else
+      mInput.addLine(command.substr(lineStart, commandLen - lineStart));
+      if (lineStart > 0)
       {
-         mPrompt = "... ";
+         // pasted text ends any block it leaves open
+         mInput.finishBlock();
       }
+
+      std::string statement;
+      while (mInput.takeStatement(statement))
+      {
+         auto_obj result(PyObject_CallMethod(mInterpreter, "run_statement", "s#",
+            statement.c_str(), static_cast<Py_ssize_t>(statement.size())), true);
+         checkErr();
+      }
+      mPrompt = mInput.isPending() ? "... " : ">>> ";
    }
    catch(const PythonError& err)
    {
       sendError(err.what());
+      mInput.reset();
+      mPrompt = ">>> ";
       retVal = false;
    }
 
-   mRunningScopedCommand = false;
+   OutputStream::flushAll();
+   if (owned)
+   {
+      mThreadContexts.erase(threadId);
+   }
    return retVal;
 }
 
-bool PythonEngine::executeScopedCommand(const std::string& command, const Slot& output,
-                                        const Slot& error, Progress* pProgress)
+bool PythonEngine::runScopedCommand(const std::string& command, ScopedContext* pContext)
 {
-   if (!mPythonRunning)
+   bool retVal = true;
+
+   // a scoped command can run another scoped command on the same thread, such as a plug-in executing a script
+   const long threadId = PyThreadState_Get()->thread_id;
+   const bool nested = mThreadContexts.find(threadId) != mThreadContexts.end();
+   ScopedContext* pOuterContext = getCurrentContext();
+   // text buffered by the outer command is sent to its own slots
+   OutputStream::flush();
+   mThreadContexts[threadId] = pContext;
+   const bool onInterpreterThread = mpInterpreterThread != NULL && QThread::currentThread() == mpInterpreterThread;
+   if (onInterpreterThread)
    {
-      return false;
+      mpInterpreterThread->setCurrentContext(pContext);
+   }
+
+   AbortMonitor* pMonitor = NULL;
+   if (pContext->getProgress() != NULL)
+   {
+      pMonitor = new AbortMonitor(pContext->getProgress(), threadId);
+      pMonitor->start();
    }
-   bool retVal = true;
-   mRunningScopedCommand = true;
-   attach(SIGNAL_NAME(PythonEngine, ScopedOutputText), output);
-   attach(SIGNAL_NAME(PythonEngine, ScopedErrorText), error);
    try
    {
-      auto_obj scopedDict(PyDict_New(), true);
-      PyRun_String(command.c_str(), Py_file_input, mGlobals.get(), scopedDict.get());
+      PyObject* pGlobals = pContext->begin(mGlobals);
+      checkErr();
+      auto_obj code;
+      const std::string& script = pContext->getScript();
+      if (script.empty())
+      {
+         code.reset(ScriptCache::compileSource(command), true);
+      }
+      else
+      {
+         auto_obj prepared(PyObject_CallMethod(mInterpModule, "prepare_script", "OsNNN", pGlobals, script.c_str(),
+            addressOf(pContext->getInputArgs()), addressOf(pContext->getOutputArgs()),
+            addressOf(pContext->getResults())), true);
+         checkErr();
+         code.reset(ScriptCache::compileFile(script), true);
+      }
+      checkErr();
+      auto_obj result(PyEval_EvalCode(reinterpret_cast<PyCodeObject*>(code.get()), pGlobals, pGlobals), true);
       checkErr();
    }
    catch(const PythonError& err)
@@ -300,58 +608,103 @@ bool PythonEngine::executeScopedCommand(const std::string& command, const Slot&
       sendError(err.what());
       retVal = false;
    }
-   detach(SIGNAL_NAME(PythonEngine, ScopedErrorText), error);
-   detach(SIGNAL_NAME(PythonEngine, ScopedOutputText), output);
-   mRunningScopedCommand = false;
+   OutputStream::flushAll();
+   if (pMonitor != NULL)
+   {
+      // the monitor may be waiting for the GIL to raise the abort
+      Py_BEGIN_ALLOW_THREADS
+      delete pMonitor;
+      Py_END_ALLOW_THREADS
+   }
+   pContext->end();
+
+   if (nested)
+   {
+      mThreadContexts[threadId] = pOuterContext;
+   }
+   else
+   {
+      mThreadContexts.erase(threadId);
+   }
+   if (onInterpreterThread)
+   {
+      mpInterpreterThread->setCurrentContext(pOuterContext);
+   }
    return retVal;
 }
 
-void PythonEngine::gatherOutput(Subject& subject, const std::string& signal, const boost::any& data)
+bool PythonEngine::isRunningCommand(long threadId) const
 {
-   std::string text = boost::any_cast<std::string>(data);
-   mGatheredOutput += text;
+   return mThreadContexts.find(threadId) != mThreadContexts.end();
 }
 
 void PythonEngine::sendOutput(const std::string& text)
 {
-   sendOutput(text, mRunningScopedCommand);
+   OutputStream::flush();
+   deliverOutput(text, false);
 }
 
-void PythonEngine::sendOutput(const std::string& text, bool scoped)
+void PythonEngine::deliverOutput(const std::string& text, bool error)
 {
-   if (text.empty())
+   ScopedContext* pContext = getCurrentContext();
+   if (mpInterpreterThread == NULL || QThread::currentThread() != mpInterpreterThread)
    {
-      return;
+      sendOutput(text, error, pContext);
    }
-   if (scoped)
+   else if (!mpInterpreterThread->postOutput(text, error, pContext) && pContext != NULL)
    {
-      notify(SIGNAL_NAME(PythonEngine, ScopedOutputText), text);
-   }
-   if (!scoped || mGlobalOutputShown)
-   {
-      notify(SIGNAL_NAME(Interpreter, OutputText), text);
+      // a command started by the running command was called from this thread so its slots are used here
+      pContext->sendOutput(*this, text, error);
+      if (mGlobalOutputShown && !text.empty())
+      {
+         mpInterpreterThread->postOutput(text, error, NULL);
+      }
    }
 }
 
-void PythonEngine::sendError(const std::string& text)
-{
-   sendError(text, mRunningScopedCommand);
-}
-
-void PythonEngine::sendError(const std::string& text, bool scoped)
+void PythonEngine::sendOutput(const std::string& text, bool error, ScopedContext* pContext)
 {
    if (text.empty())
    {
       return;
    }
-   if (scoped)
+   if (mGatheringOutput)
+   {
+      mGatheredOutput += text;
+      return;
+   }
+   if (pContext != NULL)
    {
-      notify(SIGNAL_NAME(PythonEngine, ScopedErrorText), text);
+      pContext->sendOutput(*this, text, error);
    }
-   if (!scoped || mGlobalOutputShown)
+   if (pContext == NULL || mGlobalOutputShown)
    {
-      notify(SIGNAL_NAME(Interpreter, ErrorText), text);
+      notify(error ? SIGNAL_NAME(Interpreter, ErrorText) : SIGNAL_NAME(Interpreter, OutputText), text);
+   }
+}
+
+bool PythonEngine::sendProgress(const std::string& text, int percent)
+{
+   ScopedContext* pContext = getCurrentContext();
+   Progress* pProgress = (pContext == NULL) ? NULL : pContext->getProgress();
+   if (pProgress == NULL)
+   {
+      return false;
    }
+   // keep any buffered output in step with the progress messages
+   OutputStream::flush();
+   if (mpInterpreterThread == NULL || QThread::currentThread() != mpInterpreterThread ||
+      !mpInterpreterThread->postProgress(pContext, pProgress, text, percent))
+   {
+      pProgress->updateProgress(text, percent, NORMAL);
+   }
+   return true;
+}
+
+void PythonEngine::sendError(const std::string& text)
+{
+   OutputStream::flush();
+   deliverOutput(text, true);
 }
 
 bool PythonEngine::isGlobalOutputShown() const
@@ -11,18 +11,25 @@
 #define PYTHONENGINE_H__
 
 #include "AppConfig.h"
+#include "InputTracker.h"
 #include "PythonCommon.h"
 #include "PythonInterpreter.h"
 #include "SubjectImp.h"
+#include <QtCore/QMutex>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 class External;
+class InterpreterThread;
+class ScopedContext;
 
 extern "C" PyObject* transmitOutput(PyObject* pSelf, PyObject* pArgs);
+extern "C" PyObject* transmitProgress(PyObject* pSelf, PyObject* pArgs);
 extern "C" LINKAGE PythonInterpreter* init_python_engine(External* pServices);
 extern "C" LINKAGE void shutdown_python_engine();
+extern "C" LINKAGE bool python_engine_busy();
 
 class PythonEngine : public PythonInterpreter, public SubjectImp
 {
@@ -31,6 +38,16 @@ public:
    virtual ~PythonEngine();
 
    bool isPythonRunning() const;
+
+   /**
+    * Is a caller waiting for a command on the interpreter thread? The engine can not be
+    * shut down while one is since the caller is further up the stack.
+    */
+   bool isExecuting();
+
+   bool initializePython();
+   bool importInterpreter();
+   bool runUserFile();
    bool startPython();
    std::string getStartupMessage() const;
    void setStartupMessage(const std::string& msg);
@@ -39,17 +56,43 @@ public:
    virtual bool executeCommand(const std::string& command);
    virtual bool executeScopedCommand(const std::string& command, const Slot& output,
       const Slot& error, Progress* pProgress);
+   virtual bool executeScript(const std::string& filename, PlugInArgList* pInArgList,
+      PlugInArgList* pOutArgList, DynamicObject* pResults, const Slot& output,
+      const Slot& error, Progress* pProgress);
    virtual bool isGlobalOutputShown() const;
    virtual void showGlobalOutput(bool newValue);
 
    void sendOutput(const std::string& text);
    void sendError(const std::string& text);
 
+   /**
+    * Send text to the output signals without first flushing the buffered sys.stdout and sys.stderr.
+    */
+   void deliverOutput(const std::string& text, bool error);
+
+   /**
+    * Report progress for the scoped command running on the calling thread. The GIL must be held.
+    *
+    * @return False if the running command has no Progress.
+    */
+   bool sendProgress(const std::string& text, int percent);
+
+   /**
+    * Is a command running on a thread? The GIL must be held.
+    *
+    * @param threadId
+    *        The Python thread id of the thread.
+    */
+   bool isRunningCommand(long threadId) const;
+
    virtual const std::string& getObjectType() const;
    virtual bool isKindOf(const std::string& className) const;
 
    SUBJECTADAPTER_METHODS(SubjectImp)
 
+   SIGNAL_METHOD(PythonEngine, ScopedOutputText);
+   SIGNAL_METHOD(PythonEngine, ScopedErrorText);
+
    class PythonError : public std::exception
    {
    public:
@@ -68,26 +111,47 @@ protected:
    void checkErr();
 
 private:
-   void sendOutput(const std::string& text, bool scoped);
-   void sendError(const std::string& text, bool scoped);
+   friend class InterpreterThread;
 
-   void gatherOutput(Subject& subject, const std::string& signal, const boost::any& data);
+   bool runCommand(const std::string& command, ScopedContext* pContext);
+   bool runInteractiveCommand(const std::string& command);
+   bool runScopedCommand(const std::string& command, ScopedContext* pContext);
+   InterpreterThread* getInterpreterThread();
 
-   SIGNAL_METHOD(PythonEngine, ScopedOutputText);
-   SIGNAL_METHOD(PythonEngine, ScopedErrorText);
+   ScopedContext* acquireContext(const Slot& output, const Slot& error, Progress* pProgress);
+   void releaseContext(ScopedContext* pContext);
+   ScopedContext* getCurrentContext() const;
+
+   /**
+    * Send text to a scoped command's slots and, when appropriate, the global output signals.
+    *
+    * @param pContext
+    *        The context of the command which wrote the text or NULL for an interactive command.
+    */
+   void sendOutput(const std::string& text, bool error, ScopedContext* pContext);
 
    auto_obj mInterpModule;
-   auto_obj mStdin;
    auto_obj mInterpreter;
    auto_obj mGlobals;
    auto_obj mRunModule;
+   InputTracker mInput;
    std::string mPrompt;
    bool mGlobalOutputShown;
    bool mPythonRunning;
    bool mAttemptedOneStart;
-   bool mRunningScopedCommand;
+   bool mInitializeFailed;
+   bool mImportFailed;
+   bool mUserFileRun;
    std::string mStartupMessage;
+   std::string mStartupTimings;
+   int mStartupMs;
    std::string mGatheredOutput;
+   bool mGatheringOutput;   // output is kept for the startup message instead of being sent, only used with the GIL
+   PyThreadState* mpMainThreadState;
+   InterpreterThread* mpInterpreterThread;
+   QMutex mContextMutex;
+   std::vector<ScopedContext*> mIdleContexts;
+   std::map<long, ScopedContext*> mThreadContexts;   // the running command on each thread, NULL for an interactive command, only used with the GIL
 };
 
 #endif
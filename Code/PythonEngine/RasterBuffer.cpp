@@ -0,0 +1,830 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "InterleaveConversion.h"
+#include "ObjectResource.h"
+#include "RasterBuffer.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "Slot.h"
+#include "Subject.h"
+#include "TypesFile.h"
+
+#include <QtCore/QAtomicInt>
+#include <new>
+#include <string.h>
+
+namespace
+{
+   /**
+    * Watches the raster element under a zero-copy buffer so the buffer can be invalidated
+    * when the element is destroyed. The element may be destroyed on any thread.
+    */
+   class ElementWatch
+   {
+   public:
+      ElementWatch(RasterElement* pRaster) :
+         mpRaster(pRaster),
+         mDeleted(0)
+      {
+         mpRaster->attach(SIGNAL_NAME(Subject, Deleted), Slot(this, &ElementWatch::deleted));
+      }
+
+      ~ElementWatch()
+      {
+         if (mDeleted.fetchAndStoreOrdered(1) == 0)
+         {
+            mpRaster->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &ElementWatch::deleted));
+         }
+      }
+
+      bool isDeleted() const
+      {
+         return mDeleted != 0;
+      }
+
+      void deleted(Subject& subject, const std::string& signal, const boost::any& data)
+      {
+         mDeleted.fetchAndStoreOrdered(1);
+      }
+
+   private:
+      ElementWatch(const ElementWatch& rhs);
+      ElementWatch& operator=(const ElementWatch& rhs);
+
+      RasterElement* mpRaster;
+      QAtomicInt mDeleted;
+   };
+
+   struct RasterBufferObject
+   {
+      PyObject_HEAD
+      char* mpData;        // address of the first element of the buffer
+      char* mpAllocation;  // memory owned by the buffer or NULL for a view on raster memory
+      ElementWatch* mpWatch;  // the element under a view or NULL
+      int mEncoding;
+      int mInterleave;
+      Py_ssize_t mItemSize;
+      Py_ssize_t mShape[3];
+      Py_ssize_t mStrides[3];
+   };
+
+   struct EncodingFormat
+   {
+      char mKind;
+      const char* mpFormat;
+   };
+
+   // indexed by EncodingTypeEnum
+   const EncodingFormat sEncodingFormats[] = {
+      {'i', "b"},                    // INT1SBYTE
+      {'u', "B"},                    // INT1UBYTE
+      {'i', "h"},                    // INT2SBYTES
+      {'u', "H"},                    // INT2UBYTES
+      {'V', "T{h:real:h:imag:}"},    // INT4SCOMPLEX
+      {'i', "i"},                    // INT4SBYTES
+      {'u', "I"},                    // INT4UBYTES
+      {'f', "f"},                    // FLT4BYTES
+      {'c', "Zf"},                   // FLT8COMPLEX
+      {'f', "d"}                     // FLT8BYTES
+   };
+
+   bool isLittleEndian()
+   {
+      const int one = 1;
+      return *reinterpret_cast<const char*>(&one) == 1;
+   }
+
+   using RasterBuffer::SubCube;
+   using RasterBuffer::ROW_DIM;
+   using RasterBuffer::COLUMN_DIM;
+   using RasterBuffer::BAND_DIM;
+
+   // the logical dimensions from outermost to innermost, indexed by InterleaveFormatTypeEnum
+   const int sDimensionOrder[3][3] = {
+      {BAND_DIM, ROW_DIM, COLUMN_DIM},  // BSQ
+      {ROW_DIM, COLUMN_DIM, BAND_DIM},  // BIP
+      {ROW_DIM, BAND_DIM, COLUMN_DIM}   // BIL
+   };
+
+   /**
+    * Calculate the byte strides of each logical dimension for a C ordered cube in a given interleave.
+    */
+   void contiguousStrides(int interleave, const Py_ssize_t* pCounts, Py_ssize_t itemSize, Py_ssize_t* pStrides)
+   {
+      const int* pOrder = sDimensionOrder[interleave];
+      Py_ssize_t stride = itemSize;
+      for (int idx = 2; idx >= 0; --idx)
+      {
+         pStrides[pOrder[idx]] = stride;
+         stride *= pCounts[pOrder[idx]];
+      }
+   }
+
+   /**
+    * Calculate the address and logical byte strides of a sub-cube within the raw memory of a raster element.
+    */
+   char* rawSubCube(char* pRawData, const RasterDataDescriptor* pDesc, const SubCube& cube, Py_ssize_t* pStrides)
+   {
+      Py_ssize_t fullCounts[3] = {pDesc->getRowCount(), pDesc->getColumnCount(), pDesc->getBandCount()};
+      contiguousStrides(pDesc->getInterleaveFormat(), fullCounts, pDesc->getBytesPerElement(), pStrides);
+      char* pData = pRawData;
+      for (int dim = 0; dim < 3; ++dim)
+      {
+         pData += cube.mStart[dim] * pStrides[dim];
+         pStrides[dim] *= cube.mStep[dim];
+      }
+      return pData;
+   }
+
+   /**
+    * Copy every element of a cube between two strided layouts into a cube in the destination interleave.
+    */
+   void stridedCopy(char* pDest, const Py_ssize_t* pDestStrides, const char* pSource, const Py_ssize_t* pSourceStrides,
+      const Py_ssize_t* pCounts, int destInterleave, Py_ssize_t itemSize)
+   {
+      InterleaveConversion::copy(pDest, pDestStrides, pSource, pSourceStrides, pCounts,
+         sDimensionOrder[destInterleave], itemSize);
+   }
+
+   bool isContiguous(const RasterBufferObject* pBuffer)
+   {
+      Py_ssize_t stride = pBuffer->mItemSize;
+      for (int dim = 2; dim >= 0; --dim)
+      {
+         if (pBuffer->mShape[dim] > 1 && pBuffer->mStrides[dim] != stride)
+         {
+            return false;
+         }
+         stride *= pBuffer->mShape[dim];
+      }
+      return true;
+   }
+
+   bool isValid(const RasterBufferObject* pBuffer)
+   {
+      return pBuffer->mpWatch == NULL || !pBuffer->mpWatch->isDeleted();
+   }
+
+   // set a Python exception and return false if the element under a view has been destroyed
+   bool checkValid(const RasterBufferObject* pBuffer)
+   {
+      if (!isValid(pBuffer))
+      {
+         PyErr_SetString(PyExc_ValueError, "The raster element viewed by this RasterBuffer has been destroyed.");
+         return false;
+      }
+      return true;
+   }
+
+   Py_ssize_t bufferLength(const RasterBufferObject* pBuffer)
+   {
+      return pBuffer->mShape[0] * pBuffer->mShape[1] * pBuffer->mShape[2] * pBuffer->mItemSize;
+   }
+
+   /**
+    * Copy between a sub-cube of a raster element which is not held in memory and a C ordered buffer.
+    * Data is transferred a band at a time with a BSQ accessor, which is supported for every interleave,
+    * except for BIP to BIP reads which can use the native layout.
+    * This does not touch any Python objects so it can be called without holding the GIL.
+    */
+   bool transferSubCube(RasterElement* pRaster, const SubCube& cube, int interleave, size_t itemSize,
+      char* pBuffer, bool write)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      const Py_ssize_t counts[3] = {cube.count(ROW_DIM), cube.count(COLUMN_DIM), cube.count(BAND_DIM)};
+      Py_ssize_t strides[3];
+      contiguousStrides(interleave, counts, itemSize, strides);
+
+      if (!write && interleave == BIP && pDesc->getInterleaveFormat() == BIP)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BIP);
+         pRequest->setRows(pDesc->getActiveRow(cube.mStart[ROW_DIM]), pDesc->getActiveRow(cube.mEnd[ROW_DIM]));
+         pRequest->setColumns(pDesc->getActiveColumn(cube.mStart[COLUMN_DIM]),
+            pDesc->getActiveColumn(cube.mEnd[COLUMN_DIM]));
+         pRequest->setBands(pDesc->getActiveBand(cube.mStart[BAND_DIM]), pDesc->getActiveBand(cube.mEnd[BAND_DIM]));
+         DataAccessor acc = pRaster->getDataAccessor(pRequest.release());
+         const size_t bandStep = cube.mStep[BAND_DIM] * itemSize;
+         for (Py_ssize_t row = 0; row < counts[ROW_DIM]; ++row)
+         {
+            if (!acc.isValid())
+            {
+               return false;
+            }
+            char* pPixel = pBuffer + row * strides[ROW_DIM];
+            for (Py_ssize_t column = 0; column < counts[COLUMN_DIM]; ++column)
+            {
+               const char* pSource = reinterpret_cast<const char*>(acc->getColumn());
+               if (bandStep == itemSize)
+               {
+                  memcpy(pPixel, pSource, counts[BAND_DIM] * itemSize);
+               }
+               else
+               {
+                  for (Py_ssize_t band = 0; band < counts[BAND_DIM]; ++band)
+                  {
+                     memcpy(pPixel + band * itemSize, pSource + band * bandStep, itemSize);
+                  }
+               }
+               pPixel += strides[COLUMN_DIM];
+               acc->nextColumn(cube.mStep[COLUMN_DIM]);
+            }
+            acc->nextRow(cube.mStep[ROW_DIM]);
+         }
+         return true;
+      }
+
+      const size_t columnStep = cube.mStep[COLUMN_DIM] * itemSize;
+      for (Py_ssize_t band = 0; band < counts[BAND_DIM]; ++band)
+      {
+         DimensionDescriptor bandDim = pDesc->getActiveBand(cube.mStart[BAND_DIM] + band * cube.mStep[BAND_DIM]);
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BSQ);
+         pRequest->setRows(pDesc->getActiveRow(cube.mStart[ROW_DIM]), pDesc->getActiveRow(cube.mEnd[ROW_DIM]));
+         pRequest->setColumns(pDesc->getActiveColumn(cube.mStart[COLUMN_DIM]),
+            pDesc->getActiveColumn(cube.mEnd[COLUMN_DIM]));
+         pRequest->setBands(bandDim, bandDim);
+         pRequest->setWritable(write);
+         DataAccessor acc = pRaster->getDataAccessor(pRequest.release());
+         for (Py_ssize_t row = 0; row < counts[ROW_DIM]; ++row)
+         {
+            if (!acc.isValid())
+            {
+               return false;
+            }
+            char* pRasterLine = reinterpret_cast<char*>(acc->getColumn());
+            char* pLine = pBuffer + band * strides[BAND_DIM] + row * strides[ROW_DIM];
+            if (columnStep == itemSize && strides[COLUMN_DIM] == static_cast<Py_ssize_t>(itemSize))
+            {
+               memcpy(write ? pRasterLine : pLine, write ? pLine : pRasterLine, counts[COLUMN_DIM] * itemSize);
+            }
+            else
+            {
+               for (Py_ssize_t column = 0; column < counts[COLUMN_DIM]; ++column)
+               {
+                  char* pRasterValue = pRasterLine + column * columnStep;
+                  char* pValue = pLine + column * strides[COLUMN_DIM];
+                  memcpy(write ? pRasterValue : pValue, write ? pValue : pRasterValue, itemSize);
+               }
+            }
+            acc->nextRow(cube.mStep[ROW_DIM]);
+         }
+      }
+      return true;
+   }
+
+   /**
+    * Convert a C ordered buffer of real numbers into a sub-cube of a raster element as it is written.
+    * A raster element which is not held in memory is written a band at a time through a one band buffer.
+    * This does not touch any Python objects so it can be called without holding the GIL.
+    *
+    * @see InterleaveConversion::convert()
+    */
+   bool convertSubCube(RasterElement* pRaster, const SubCube& cube, int interleave, const char* pSource,
+      char sourceFormat, double scale, double offset)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      const int encoding = pDesc->getDataType();
+      const Py_ssize_t itemSize = pDesc->getBytesPerElement();
+      const Py_ssize_t counts[3] = {cube.count(ROW_DIM), cube.count(COLUMN_DIM), cube.count(BAND_DIM)};
+      Py_ssize_t sourceStrides[3];
+      contiguousStrides(interleave, counts, InterleaveConversion::convertibleSize(sourceFormat), sourceStrides);
+      char* pRawData = reinterpret_cast<char*>(pRaster->getRawData());
+      if (pRawData != NULL)
+      {
+         Py_ssize_t rawStrides[3];
+         char* pRawSubCube = rawSubCube(pRawData, pDesc, cube, rawStrides);
+         return InterleaveConversion::convert(pRawSubCube, rawStrides, pSource, sourceStrides, counts,
+            sDimensionOrder[pDesc->getInterleaveFormat()], sourceFormat, encoding, scale, offset);
+      }
+
+      const Py_ssize_t bandCounts[3] = {counts[ROW_DIM], counts[COLUMN_DIM], 1};
+      Py_ssize_t bandStrides[3];
+      contiguousStrides(interleave, bandCounts, itemSize, bandStrides);
+      char* pBand = new (std::nothrow) char[bandCounts[ROW_DIM] * bandCounts[COLUMN_DIM] * itemSize];
+      bool success = pBand != NULL;
+      SubCube band = cube;
+      for (Py_ssize_t idx = 0; success && idx < counts[BAND_DIM]; ++idx)
+      {
+         band.mStart[BAND_DIM] = cube.mStart[BAND_DIM] + idx * cube.mStep[BAND_DIM];
+         band.mEnd[BAND_DIM] = band.mStart[BAND_DIM];
+         success = InterleaveConversion::convert(pBand, bandStrides, pSource + idx * sourceStrides[BAND_DIM],
+            sourceStrides, bandCounts, sDimensionOrder[interleave], sourceFormat, encoding, scale, offset) &&
+            transferSubCube(pRaster, band, interleave, itemSize, pBand, true);
+      }
+      delete [] pBand;
+      return success;
+   }
+
+   /**
+    * Parse the common (handle, row_start, row_end, column_start, column_end, band_start, band_end, interleave)
+    * arguments along with the trailing optional arguments described by format.
+    *
+    * @return The raster element or NULL if a Python exception has been set.
+    */
+   RasterElement* parseSubCube(PyObject* pArgs, const char* pFormat, SubCube& cube, int& interleave,
+      PyObject** pData = NULL)
+   {
+      PyObject* pHandle = NULL;
+      cube.mStep[ROW_DIM] = 1;
+      cube.mStep[COLUMN_DIM] = 1;
+      cube.mStep[BAND_DIM] = 1;
+      bool parsed = false;
+      if (pData == NULL)
+      {
+         parsed = PyArg_ParseTuple(pArgs, pFormat, &pHandle,
+            &cube.mStart[ROW_DIM], &cube.mEnd[ROW_DIM], &cube.mStart[COLUMN_DIM], &cube.mEnd[COLUMN_DIM],
+            &cube.mStart[BAND_DIM], &cube.mEnd[BAND_DIM], &interleave,
+            &cube.mStep[ROW_DIM], &cube.mStep[COLUMN_DIM], &cube.mStep[BAND_DIM]) != 0;
+      }
+      else
+      {
+         parsed = PyArg_ParseTuple(pArgs, pFormat, &pHandle,
+            &cube.mStart[ROW_DIM], &cube.mEnd[ROW_DIM], &cube.mStart[COLUMN_DIM], &cube.mEnd[COLUMN_DIM],
+            &cube.mStart[BAND_DIM], &cube.mEnd[BAND_DIM], &interleave, pData,
+            &cube.mStep[ROW_DIM], &cube.mStep[COLUMN_DIM], &cube.mStep[BAND_DIM]) != 0;
+      }
+      if (!parsed)
+      {
+         return NULL;
+      }
+      RasterElement* pRaster = RasterBuffer::toRasterElement(pHandle);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      const unsigned int dimensions[3] = {pDesc->getRowCount(), pDesc->getColumnCount(), pDesc->getBandCount()};
+      for (int dim = 0; dim < 3; ++dim)
+      {
+         if (cube.mEnd[dim] < cube.mStart[dim] || cube.mEnd[dim] >= dimensions[dim])
+         {
+            PyErr_SetString(PyExc_IndexError, "Sub-cube is outside of the raster element.");
+            return NULL;
+         }
+         if (cube.mStep[dim] < 1)
+         {
+            PyErr_SetString(PyExc_IndexError, "Step factors must be positive.");
+            return NULL;
+         }
+      }
+      if (interleave != BSQ && interleave != BIP && interleave != BIL)
+      {
+         PyErr_SetString(PyExc_ValueError, "Invalid interleave.");
+         return NULL;
+      }
+      const int encoding = pDesc->getDataType();
+      if (encoding < INT1SBYTE || encoding > FLT8BYTES)
+      {
+         PyErr_SetString(PyExc_TypeError, "The raster element's encoding can't be represented.");
+         return NULL;
+      }
+      return pRaster;
+   }
+
+   void rasterBufferDealloc(RasterBufferObject* pSelf)
+   {
+      delete [] pSelf->mpAllocation;
+      delete pSelf->mpWatch;
+      pSelf->ob_type->tp_free(reinterpret_cast<PyObject*>(pSelf));
+   }
+
+   Py_ssize_t rasterBufferSegmentCount(RasterBufferObject* pSelf, Py_ssize_t* pLength)
+   {
+      if (pLength != NULL)
+      {
+         *pLength = bufferLength(pSelf);
+      }
+      return 1;
+   }
+
+   Py_ssize_t rasterBufferGetBuffer(RasterBufferObject* pSelf, Py_ssize_t segment, void** pPtr)
+   {
+      if (segment != 0)
+      {
+         PyErr_SetString(PyExc_SystemError, "Accessing non-existent RasterBuffer segment.");
+         return -1;
+      }
+      if (!checkValid(pSelf))
+      {
+         return -1;
+      }
+      if (!isContiguous(pSelf))
+      {
+         PyErr_SetString(PyExc_TypeError,
+            "RasterBuffer is not contiguous. Use the array interface to access strided data.");
+         return -1;
+      }
+      *pPtr = pSelf->mpData;
+      return bufferLength(pSelf);
+   }
+
+   Py_ssize_t rasterBufferGetCharBuffer(RasterBufferObject* pSelf, Py_ssize_t segment, char** pPtr)
+   {
+      return rasterBufferGetBuffer(pSelf, segment, reinterpret_cast<void**>(pPtr));
+   }
+
+#if PY_VERSION_HEX >= 0x02060000
+   int rasterBufferGetNewBuffer(RasterBufferObject* pSelf, Py_buffer* pView, int flags)
+   {
+      if (!checkValid(pSelf))
+      {
+         return -1;
+      }
+      if ((flags & PyBUF_STRIDES) != PyBUF_STRIDES && !isContiguous(pSelf))
+      {
+         PyErr_SetString(PyExc_BufferError, "RasterBuffer is not contiguous.");
+         return -1;
+      }
+      pView->obj = reinterpret_cast<PyObject*>(pSelf);
+      Py_INCREF(pView->obj);
+      pView->buf = pSelf->mpData;
+      pView->len = bufferLength(pSelf);
+      pView->readonly = 0;
+      pView->itemsize = pSelf->mItemSize;
+      pView->format = NULL;
+      if ((flags & PyBUF_FORMAT) == PyBUF_FORMAT)
+      {
+         pView->format = const_cast<char*>(sEncodingFormats[pSelf->mEncoding].mpFormat);
+      }
+      pView->ndim = 3;
+      pView->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? pSelf->mShape : NULL;
+      pView->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? pSelf->mStrides : NULL;
+      pView->suboffsets = NULL;
+      pView->internal = NULL;
+      return 0;
+   }
+#endif
+
+   PyObject* rasterBufferArrayInterface(RasterBufferObject* pSelf, void*)
+   {
+      if (!checkValid(pSelf))
+      {
+         return NULL;
+      }
+      const EncodingFormat& format = sEncodingFormats[pSelf->mEncoding];
+      char byteOrder = isLittleEndian() ? '<' : '>';
+      auto_obj pTypeStr(NULL);
+      auto_obj pDescr(NULL);
+      if (pSelf->mEncoding == INT4SCOMPLEX)
+      {
+         pTypeStr.reset(PyString_FromString("|V4"), true);
+         char componentType[] = {byteOrder, 'i', '2', '\0'};
+         pDescr.reset(Py_BuildValue("[(ss)(ss)]", "real", componentType, "imag", componentType), true);
+      }
+      else
+      {
+         if (pSelf->mItemSize == 1)
+         {
+            byteOrder = '|';
+         }
+         pTypeStr.reset(PyString_FromFormat("%c%c%d", byteOrder, format.mKind, static_cast<int>(pSelf->mItemSize)), true);
+         pDescr.reset(Py_BuildValue("[(sO)]", "", pTypeStr.get()), true);
+      }
+      if (pTypeStr.get() == NULL || pDescr.get() == NULL)
+      {
+         return NULL;
+      }
+      return Py_BuildValue("{s:(nnn),s:(nnn),s:O,s:O,s:(NO),s:i}",
+         "shape", pSelf->mShape[0], pSelf->mShape[1], pSelf->mShape[2],
+         "strides", pSelf->mStrides[0], pSelf->mStrides[1], pSelf->mStrides[2],
+         "typestr", pTypeStr.get(),
+         "descr", pDescr.get(),
+         "data", PyLong_FromVoidPtr(pSelf->mpData), Py_False,
+         "version", 3);
+   }
+
+   PyObject* rasterBufferGetShape(RasterBufferObject* pSelf, void*)
+   {
+      return Py_BuildValue("(nnn)", pSelf->mShape[0], pSelf->mShape[1], pSelf->mShape[2]);
+   }
+
+   PyObject* rasterBufferGetStrides(RasterBufferObject* pSelf, void*)
+   {
+      return Py_BuildValue("(nnn)", pSelf->mStrides[0], pSelf->mStrides[1], pSelf->mStrides[2]);
+   }
+
+   PyObject* rasterBufferGetInterleave(RasterBufferObject* pSelf, void*)
+   {
+      return PyInt_FromLong(pSelf->mInterleave);
+   }
+
+   PyObject* rasterBufferGetEncoding(RasterBufferObject* pSelf, void*)
+   {
+      return PyInt_FromLong(pSelf->mEncoding);
+   }
+
+   PyObject* rasterBufferGetOwnsData(RasterBufferObject* pSelf, void*)
+   {
+      return PyBool_FromLong(pSelf->mpAllocation != NULL);
+   }
+
+   PyObject* rasterBufferGetValid(RasterBufferObject* pSelf, void*)
+   {
+      return PyBool_FromLong(isValid(pSelf));
+   }
+
+   PyGetSetDef sRasterBufferGetSet[] = {
+      {const_cast<char*>("__array_interface__"), reinterpret_cast<getter>(rasterBufferArrayInterface), NULL,
+         const_cast<char*>("The numpy array interface for this buffer."), NULL},
+      {const_cast<char*>("shape"), reinterpret_cast<getter>(rasterBufferGetShape), NULL,
+         const_cast<char*>("The dimensions of the buffer in interleave order."), NULL},
+      {const_cast<char*>("strides"), reinterpret_cast<getter>(rasterBufferGetStrides), NULL,
+         const_cast<char*>("The byte strides of each dimension."), NULL},
+      {const_cast<char*>("interleave"), reinterpret_cast<getter>(rasterBufferGetInterleave), NULL,
+         const_cast<char*>("The interleave of the buffer as an opticks.Interleave value."), NULL},
+      {const_cast<char*>("encoding"), reinterpret_cast<getter>(rasterBufferGetEncoding), NULL,
+         const_cast<char*>("The encoding of the buffer as an opticks.Encoding value."), NULL},
+      {const_cast<char*>("owns_data"), reinterpret_cast<getter>(rasterBufferGetOwnsData), NULL,
+         const_cast<char*>("False if the buffer is a view on the raster element's memory."), NULL},
+      {const_cast<char*>("valid"), reinterpret_cast<getter>(rasterBufferGetValid), NULL,
+         const_cast<char*>("False once the raster element under a view has been destroyed."), NULL},
+      {NULL, NULL, NULL, NULL, NULL} // sentinel
+   };
+
+   PyBufferProcs sRasterBufferProcs = {
+      reinterpret_cast<readbufferproc>(rasterBufferGetBuffer),
+      reinterpret_cast<writebufferproc>(rasterBufferGetBuffer),
+      reinterpret_cast<segcountproc>(rasterBufferSegmentCount),
+      reinterpret_cast<charbufferproc>(rasterBufferGetCharBuffer)
+#if PY_VERSION_HEX >= 0x02060000
+      , reinterpret_cast<getbufferproc>(rasterBufferGetNewBuffer),
+      NULL
+#endif
+   };
+
+#if PY_VERSION_HEX >= 0x02060000
+#define RASTERBUFFER_TPFLAGS (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER)
+#else
+#define RASTERBUFFER_TPFLAGS Py_TPFLAGS_DEFAULT
+#endif
+
+   PyTypeObject sRasterBufferType = {
+      PyObject_HEAD_INIT(NULL)
+      0,                                                 // ob_size
+      "_opticks.RasterBuffer",                           // tp_name
+      sizeof(RasterBufferObject),                        // tp_basicsize
+      0,                                                 // tp_itemsize
+      reinterpret_cast<destructor>(rasterBufferDealloc), // tp_dealloc
+      0,                                                 // tp_print
+      0,                                                 // tp_getattr
+      0,                                                 // tp_setattr
+      0,                                                 // tp_compare
+      0,                                                 // tp_repr
+      0,                                                 // tp_as_number
+      0,                                                 // tp_as_sequence
+      0,                                                 // tp_as_mapping
+      0,                                                 // tp_hash
+      0,                                                 // tp_call
+      0,                                                 // tp_str
+      0,                                                 // tp_getattro
+      0,                                                 // tp_setattro
+      &sRasterBufferProcs,                               // tp_as_buffer
+      RASTERBUFFER_TPFLAGS,                              // tp_flags
+      "A view of raster element data. Use numpy.asarray() to access the data.", // tp_doc
+      0,                                                 // tp_traverse
+      0,                                                 // tp_clear
+      0,                                                 // tp_richcompare
+      0,                                                 // tp_weaklistoffset
+      0,                                                 // tp_iter
+      0,                                                 // tp_iternext
+      0,                                                 // tp_methods
+      0,                                                 // tp_members
+      sRasterBufferGetSet                                // tp_getset
+   };
+}
+
+namespace RasterBuffer
+{
+   bool registerType(PyObject* pModule)
+   {
+      if (PyType_Ready(&sRasterBufferType) < 0)
+      {
+         return false;
+      }
+      Py_INCREF(&sRasterBufferType);
+      return PyModule_AddObject(pModule, "RasterBuffer", reinterpret_cast<PyObject*>(&sRasterBufferType)) == 0;
+   }
+
+   RasterElement* toRasterElement(PyObject* pHandle)
+   {
+      void* pAddress = PyLong_AsVoidPtr(pHandle);
+      if (pAddress == NULL)
+      {
+         if (!PyErr_Occurred())
+         {
+            PyErr_SetString(PyExc_ValueError, "Invalid raster element handle.");
+         }
+         return NULL;
+      }
+      RasterElement* pRaster = dynamic_cast<RasterElement*>(reinterpret_cast<DataElement*>(pAddress));
+      if (pRaster == NULL)
+      {
+         PyErr_SetString(PyExc_TypeError, "Handle is not a raster element.");
+      }
+      return pRaster;
+   }
+
+   bool readSubCube(RasterElement* pRaster, const SubCube& cube, int interleave, char* pDest)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      const Py_ssize_t itemSize = pDesc->getBytesPerElement();
+      char* pRawData = reinterpret_cast<char*>(pRaster->getRawData());
+      if (pRawData == NULL)
+      {
+         return transferSubCube(pRaster, cube, interleave, itemSize, pDest, false);
+      }
+      const Py_ssize_t counts[3] = {cube.count(ROW_DIM), cube.count(COLUMN_DIM), cube.count(BAND_DIM)};
+      Py_ssize_t rawStrides[3];
+      Py_ssize_t strides[3];
+      char* pRawSubCube = rawSubCube(pRawData, pDesc, cube, rawStrides);
+      contiguousStrides(interleave, counts, itemSize, strides);
+      stridedCopy(pDest, strides, pRawSubCube, rawStrides, counts, interleave, itemSize);
+      return true;
+   }
+
+   PyObject* createBuffer(RasterElement* pRaster, const SubCube& cube, int interleave, char* pAllocation)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      RasterBufferObject* pBuffer = PyObject_New(RasterBufferObject, &sRasterBufferType);
+      if (pBuffer == NULL)
+      {
+         delete [] pAllocation;
+         return NULL;
+      }
+      pBuffer->mpData = pAllocation;
+      pBuffer->mpAllocation = pAllocation;
+      pBuffer->mpWatch = NULL;
+      pBuffer->mEncoding = pDesc->getDataType();
+      pBuffer->mInterleave = interleave;
+      pBuffer->mItemSize = pDesc->getBytesPerElement();
+
+      const int* pOrder = sDimensionOrder[interleave];
+      const Py_ssize_t counts[3] = {cube.count(ROW_DIM), cube.count(COLUMN_DIM), cube.count(BAND_DIM)};
+      Py_ssize_t strides[3];
+      char* pRawData = reinterpret_cast<char*>(pRaster->getRawData());
+      if (pAllocation == NULL && pRawData != NULL)
+      {
+         // view the raster memory directly
+         pBuffer->mpData = rawSubCube(pRawData, pDesc, cube, strides);
+         pBuffer->mpWatch = new ElementWatch(pRaster);
+      }
+      else
+      {
+         contiguousStrides(interleave, counts, pBuffer->mItemSize, strides);
+      }
+      for (int idx = 0; idx < 3; ++idx)
+      {
+         pBuffer->mShape[idx] = counts[pOrder[idx]];
+         pBuffer->mStrides[idx] = strides[pOrder[idx]];
+      }
+      return reinterpret_cast<PyObject*>(pBuffer);
+   }
+
+   PyObject* raster_buffer(PyObject*, PyObject* pArgs)
+   {
+      SubCube cube;
+      int interleave = 0;
+      RasterElement* pRaster = parseSubCube(pArgs, "OIIIIIIi|III", cube, interleave);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      if (pRaster->getRawData() != NULL && interleave == static_cast<int>(pDesc->getInterleaveFormat()))
+      {
+         return createBuffer(pRaster, cube, interleave, NULL);
+      }
+
+      const size_t length = cube.count(ROW_DIM) * cube.count(COLUMN_DIM) * cube.count(BAND_DIM) *
+         pDesc->getBytesPerElement();
+      char* pAllocation = new (std::nothrow) char[length];
+      if (pAllocation == NULL)
+      {
+         return PyErr_NoMemory();
+      }
+      bool success = true;
+      Py_BEGIN_ALLOW_THREADS
+      success = readSubCube(pRaster, cube, interleave, pAllocation);
+      Py_END_ALLOW_THREADS
+      if (!success)
+      {
+         delete [] pAllocation;
+         PyErr_SetString(PyExc_RuntimeError, "Unable to access the raster element data.");
+         return NULL;
+      }
+      return createBuffer(pRaster, cube, interleave, pAllocation);
+   }
+
+   PyObject* raster_write(PyObject*, PyObject* pArgs)
+   {
+      SubCube cube;
+      int interleave = 0;
+      PyObject* pData = NULL;
+      const char* pSourceFormat = NULL;
+      double scale = 1.0;
+      double offset = 0.0;
+      auto_obj subCubeArgs(PyTuple_GetSlice(pArgs, 0, 12), true);
+      auto_obj conversionArgs(PyTuple_GetSlice(pArgs, 12, PY_SSIZE_T_MAX), true);
+      if (subCubeArgs.get() == NULL || conversionArgs.get() == NULL ||
+         !PyArg_ParseTuple(conversionArgs, "|zdd:raster_write", &pSourceFormat, &scale, &offset))
+      {
+         return NULL;
+      }
+      RasterElement* pRaster = parseSubCube(subCubeArgs, "OIIIIIIiO|III:raster_write", cube, interleave, &pData);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      const Py_ssize_t itemSize = pDesc->getBytesPerElement();
+      Py_ssize_t sourceItemSize = itemSize;
+      if (pSourceFormat != NULL)
+      {
+         sourceItemSize = strlen(pSourceFormat) == 1 ? InterleaveConversion::convertibleSize(*pSourceFormat) : 0;
+         if (sourceItemSize == 0)
+         {
+            PyErr_Format(PyExc_TypeError, "Items of format '%s' can't be converted.", pSourceFormat);
+            return NULL;
+         }
+         if (pDesc->getDataType() == INT4SCOMPLEX || pDesc->getDataType() == FLT8COMPLEX)
+         {
+            PyErr_SetString(PyExc_TypeError, "Data can't be converted to a complex encoding.");
+            return NULL;
+         }
+      }
+      const Py_ssize_t counts[3] = {cube.count(ROW_DIM), cube.count(COLUMN_DIM), cube.count(BAND_DIM)};
+      const void* pSource = NULL;
+      Py_ssize_t sourceLength = 0;
+      if (PyObject_AsReadBuffer(pData, &pSource, &sourceLength) != 0)
+      {
+         return NULL;
+      }
+      if (sourceLength != counts[ROW_DIM] * counts[COLUMN_DIM] * counts[BAND_DIM] * sourceItemSize)
+      {
+         PyErr_Format(PyExc_ValueError, "Data has %d bytes, but must have %d bytes",
+            static_cast<int>(sourceLength), static_cast<int>(counts[ROW_DIM] * counts[COLUMN_DIM] *
+            counts[BAND_DIM] * sourceItemSize));
+         return NULL;
+      }
+
+      char* pRawData = reinterpret_cast<char*>(pRaster->getRawData());
+      bool success = true;
+      Py_BEGIN_ALLOW_THREADS
+      if (pSourceFormat != NULL)
+      {
+         success = convertSubCube(pRaster, cube, interleave, reinterpret_cast<const char*>(pSource),
+            *pSourceFormat, scale, offset);
+      }
+      else if (pRawData != NULL)
+      {
+         Py_ssize_t rawStrides[3];
+         Py_ssize_t strides[3];
+         char* pRawSubCube = rawSubCube(pRawData, pDesc, cube, rawStrides);
+         contiguousStrides(interleave, counts, itemSize, strides);
+         stridedCopy(pRawSubCube, rawStrides, reinterpret_cast<const char*>(pSource), strides, counts,
+            pDesc->getInterleaveFormat(), itemSize);
+      }
+      else
+      {
+         success = transferSubCube(pRaster, cube, interleave, itemSize,
+            const_cast<char*>(reinterpret_cast<const char*>(pSource)), true);
+      }
+      Py_END_ALLOW_THREADS
+      if (!success)
+      {
+         PyErr_SetString(PyExc_RuntimeError, "Unable to write to the raster element.");
+         return NULL;
+      }
+      pRaster->updateData();
+      Py_RETURN_NONE;
+   }
+
+   PyObject* raster_info(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      if (!PyArg_ParseTuple(pArgs, "O", &pHandle))
+      {
+         return NULL;
+      }
+      RasterElement* pRaster = toRasterElement(pHandle);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      return Py_BuildValue("(IIIiiI)", pDesc->getRowCount(), pDesc->getColumnCount(), pDesc->getBandCount(),
+         static_cast<int>(pDesc->getInterleaveFormat()), static_cast<int>(pDesc->getDataType()),
+         pDesc->getBytesPerElement());
+   }
+}
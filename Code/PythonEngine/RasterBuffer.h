@@ -0,0 +1,131 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef RASTERBUFFER_H
+#define RASTERBUFFER_H
+
+#include "PythonCommon.h"
+
+class RasterElement;
+
+/**
+ * Native access to RasterElement memory from Python.
+ *
+ * A RasterBuffer exposes a sub-cube of a raster element through the buffer protocol
+ * and the numpy array interface. If the element is held in memory and the requested
+ * interleave matches the element's interleave, the buffer is a strided view directly
+ * on the raster memory. Otherwise the sub-cube is copied into memory owned by the buffer
+ * and released when the buffer is deallocated. A zero-copy buffer watches the element and is
+ * invalidated when the element is destroyed. After that its buffer interfaces raise ValueError,
+ * but arrays created from it earlier must not be used.
+ */
+namespace RasterBuffer
+{
+   enum Dimension { ROW_DIM = 0, COLUMN_DIM = 1, BAND_DIM = 2 };
+
+   /**
+    * An inclusive, possibly decimated, sub-cube of a raster element.
+    * Each array is indexed by ROW_DIM, COLUMN_DIM and BAND_DIM.
+    */
+   struct SubCube
+   {
+      unsigned int mStart[3];
+      unsigned int mEnd[3];
+      unsigned int mStep[3];
+
+      Py_ssize_t count(int dim) const
+      {
+         return (mEnd[dim] - mStart[dim]) / mStep[dim] + 1;
+      }
+   };
+
+   /**
+    * Add the RasterBuffer type to a module.
+    *
+    * @param pModule
+    *        The module which will contain the type.
+    *
+    * @return True on success, false if a Python exception has been set.
+    */
+   bool registerType(PyObject* pModule);
+
+   /**
+    * Convert an opaque element handle, as stored in opticks.DataElement.handle, to a RasterElement.
+    *
+    * @param pHandle
+    *        An integer containing the address of the element.
+    *
+    * @return The RasterElement or NULL if a Python exception has been set.
+    */
+   RasterElement* toRasterElement(PyObject* pHandle);
+
+   /**
+    * Copy a sub-cube of a raster element into a C ordered buffer.
+    * This does not use any Python objects so it may be called without holding the GIL.
+    *
+    * @param pRaster
+    *        The source raster element.
+    * @param cube
+    *        The sub-cube to copy.
+    * @param interleave
+    *        The interleave of the destination buffer.
+    * @param pDest
+    *        The destination which must hold the entire sub-cube.
+    *
+    * @return True on success, false if the raster data could not be accessed.
+    */
+   bool readSubCube(RasterElement* pRaster, const SubCube& cube, int interleave, char* pDest);
+
+   /**
+    * Create a RasterBuffer for a sub-cube. The GIL must be held.
+    *
+    * @param pRaster
+    *        The raster element.
+    * @param cube
+    *        The sub-cube described by the buffer.
+    * @param interleave
+    *        The interleave of the buffer.
+    * @param pAllocation
+    *        Memory allocated with new[] which was filled by readSubCube(). The buffer takes ownership.
+    *        If this is NULL, the buffer is a view on the raster element's memory which must match interleave.
+    *        The view is invalidated when the element is destroyed.
+    *
+    * @return A new reference to the buffer or NULL if a Python exception has been set.
+    */
+   PyObject* createBuffer(RasterElement* pRaster, const SubCube& cube, int interleave, char* pAllocation);
+
+   /**
+    * raster_buffer(handle, row_start, row_end, column_start, column_end, band_start, band_end, interleave,
+    *               row_step=1, column_step=1, band_step=1)
+    *
+    * Create a RasterBuffer for an inclusive sub-cube of a raster element.
+    * Only every n-th row, column and band is included when a step is specified.
+    */
+   PyObject* raster_buffer(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * raster_write(handle, row_start, row_end, column_start, column_end, band_start, band_end, interleave, data,
+    *              row_step=1, column_step=1, band_step=1, format=None, scale=1.0, offset=0.0)
+    *
+    * Copy a C ordered buffer in the specified interleave into a sub-cube of a raster element
+    * and notify the element that its data has changed. If format is specified, data holds items
+    * of that struct module format which are scaled, rounded and clamped to the element's encoding
+    * as they are written. See InterleaveConversion::convert().
+    */
+   PyObject* raster_write(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * raster_info(handle)
+    *
+    * Return (rows, columns, bands, interleave, encoding, encoding_size) for a raster element.
+    */
+   PyObject* raster_info(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "PythonEngine.h"
+#include "ScopedContext.h"
+#include "Subject.h"
+
+ScopedContext::ScopedContext() :
+   mpProgress(NULL),
+   mpInArgList(NULL),
+   mpOutArgList(NULL),
+   mpResults(NULL)
+{
+}
+
+ScopedContext::~ScopedContext()
+{
+}
+
+void ScopedContext::setTarget(const Slot& output, const Slot& error, Progress* pProgress)
+{
+   mOutput = output;
+   mError = error;
+   mpProgress = pProgress;
+}
+
+void ScopedContext::setScript(const std::string& filename, PlugInArgList* pInArgList,
+                              PlugInArgList* pOutArgList, DynamicObject* pResults)
+{
+   mScript = filename;
+   mpInArgList = pInArgList;
+   mpOutArgList = pOutArgList;
+   mpResults = pResults;
+}
+
+PyObject* ScopedContext::begin(PyObject* pBaseGlobals)
+{
+   // names defined by the user file are visible, but assignments stay in this command's dictionary
+   mGlobals.reset(PyDict_Copy(pBaseGlobals), true);
+   return mGlobals.get();
+}
+
+void ScopedContext::end()
+{
+   // functions defined by the command may still refer to the dictionary, so it is released and not cleared
+   mGlobals.reset(NULL);
+}
+
+Progress* ScopedContext::getProgress() const
+{
+   return mpProgress;
+}
+
+const std::string& ScopedContext::getScript() const
+{
+   return mScript;
+}
+
+PlugInArgList* ScopedContext::getInputArgs() const
+{
+   return mpInArgList;
+}
+
+PlugInArgList* ScopedContext::getOutputArgs() const
+{
+   return mpOutArgList;
+}
+
+DynamicObject* ScopedContext::getResults() const
+{
+   return mpResults;
+}
+
+void ScopedContext::sendOutput(Subject& subject, const std::string& text, bool error) const
+{
+   if (error)
+   {
+      mError.update(subject, SIGNAL_NAME(PythonEngine, ScopedErrorText), text);
+   }
+   else
+   {
+      mOutput.update(subject, SIGNAL_NAME(PythonEngine, ScopedOutputText), text);
+   }
+}
@@ -0,0 +1,92 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SCOPEDCONTEXT_H
+#define SCOPEDCONTEXT_H
+
+#include "PythonCommon.h"
+#include "Slot.h"
+
+#include <string>
+
+class DynamicObject;
+class PlugInArgList;
+class Progress;
+class Subject;
+
+/**
+ * The state of a running scoped command: its globals, where its output goes and its progress.
+ *
+ * Each scoped command runs in its own context so commands from different callers, which may
+ * run at the same time on different threads, don't share variables or output. Contexts are
+ * pooled by the PythonEngine, but every command gets a new globals dictionary.
+ */
+class ScopedContext
+{
+public:
+   ScopedContext();
+
+   ~ScopedContext();
+
+   /**
+    * Set where output from the context's command is sent. The GIL is not needed.
+    */
+   void setTarget(const Slot& output, const Slot& error, Progress* pProgress);
+
+   /**
+    * Run a script file instead of a command string. The GIL is not needed.
+    *
+    * @param filename
+    *        The full path of the script or an empty string to run a command string.
+    */
+   void setScript(const std::string& filename, PlugInArgList* pInArgList, PlugInArgList* pOutArgList,
+      DynamicObject* pResults);
+
+   /**
+    * Create the command's globals as a copy of the engine's globals. The GIL must be held.
+    *
+    * @return A borrowed reference to the globals or NULL if a Python exception has been set.
+    */
+   PyObject* begin(PyObject* pBaseGlobals);
+
+   /**
+    * Release the context's reference to the command's globals. The GIL must be held.
+    * Objects which still refer to the globals, such as callbacks registered by the command, keep them alive.
+    */
+   void end();
+
+   Progress* getProgress() const;
+   const std::string& getScript() const;
+   PlugInArgList* getInputArgs() const;
+   PlugInArgList* getOutputArgs() const;
+   DynamicObject* getResults() const;
+
+   /**
+    * Send text to the output or error slot.
+    *
+    * @param subject
+    *        The subject passed to the slot.
+    */
+   void sendOutput(Subject& subject, const std::string& text, bool error) const;
+
+private:
+   ScopedContext(const ScopedContext& rhs);
+   ScopedContext& operator=(const ScopedContext& rhs);
+
+   auto_obj mGlobals;
+   Slot mOutput;
+   Slot mError;
+   Progress* mpProgress;
+   std::string mScript;
+   PlugInArgList* mpInArgList;
+   PlugInArgList* mpOutArgList;
+   DynamicObject* mpResults;
+};
+
+#endif
@@ -0,0 +1,299 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "PythonInterpreter.h"
+#include "ScriptCache.h"
+
+#include <marshal.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QString>
+
+#include <list>
+#include <map>
+#include <string.h>
+
+namespace
+{
+   const quint32 CACHE_TAG = 0x4f505943; // "OPYC"
+
+   struct CacheHeader
+   {
+      quint32 mTag;
+      quint32 mMagic;          // the bytecode version, from PyImport_GetMagicNumber()
+      qint64 mModified;
+      qint64 mSize;
+      quint64 mHash;
+      quint32 mPathLength;
+      quint32 mCodeLength;
+   };
+
+   quint64 hashBytes(const char* pData, qint64 size)
+   {
+      // FNV-1a
+      quint64 hash = Q_UINT64_C(14695981039346656037);
+      for (qint64 i = 0; i < size; ++i)
+      {
+         hash ^= static_cast<unsigned char>(pData[i]);
+         hash *= Q_UINT64_C(1099511628211);
+      }
+      return hash;
+   }
+
+   struct CachedCode
+   {
+      std::string mSource;
+      PyObject* mpCode;
+   };
+
+   // most recently used first
+   typedef std::list<CachedCode> CachedCodeList;
+   CachedCodeList sCachedCode;
+   std::multimap<quint64, CachedCodeList::iterator> sCachedCodeIndex;
+   unsigned long long sHits = 0;
+   unsigned long long sMisses = 0;
+
+   void evict(unsigned int capacity)
+   {
+      while (sCachedCode.size() > capacity)
+      {
+         CachedCodeList::iterator pOldest = --sCachedCode.end();
+         quint64 hash = hashBytes(pOldest->mSource.data(), pOldest->mSource.size());
+         typedef std::multimap<quint64, CachedCodeList::iterator>::iterator IndexIterator;
+         std::pair<IndexIterator, IndexIterator> matches = sCachedCodeIndex.equal_range(hash);
+         for (IndexIterator pMatch = matches.first; pMatch != matches.second; ++pMatch)
+         {
+            if (pMatch->second == pOldest)
+            {
+               sCachedCodeIndex.erase(pMatch);
+               break;
+            }
+         }
+         Py_DECREF(pOldest->mpCode);
+         sCachedCode.erase(pOldest);
+      }
+   }
+
+   QString cacheFilename(const std::string& filename)
+   {
+      QString directory = QString::fromStdString(Service<ConfigurationSettings>()->getUserStorageDirectory()) +
+         "/PythonCache";
+      QDir().mkpath(directory);
+      return directory + QString("/%1-%2%3.cache")
+         .arg(hashBytes(filename.data(), filename.size()), 16, 16, QChar('0'))
+         .arg(PY_MAJOR_VERSION).arg(PY_MINOR_VERSION);
+   }
+
+   /**
+    * Memory map a file, reading it instead if it can't be mapped.
+    */
+   class MappedFile
+   {
+   public:
+      MappedFile(const QString& filename) : mFile(filename), mpData(NULL), mSize(-1)
+      {
+         if (!mFile.open(QFile::ReadOnly))
+         {
+            return;
+         }
+         mSize = mFile.size();
+         if (mSize == 0)
+         {
+            mpData = "";
+            return;
+         }
+         uchar* pMapped = mFile.map(0, mSize);
+         if (pMapped != NULL)
+         {
+            mpData = reinterpret_cast<const char*>(pMapped);
+         }
+         else
+         {
+            mContents = mFile.readAll();
+            mpData = (mContents.size() == mSize) ? mContents.constData() : NULL;
+         }
+      }
+
+      bool isValid() const
+      {
+         return mpData != NULL;
+      }
+
+      const char* data() const
+      {
+         return mpData;
+      }
+
+      qint64 size() const
+      {
+         return mSize;
+      }
+
+   private:
+      QFile mFile;
+      QByteArray mContents;
+      const char* mpData;
+      qint64 mSize;
+   };
+
+   PyObject* loadCache(const QString& cacheName, const CacheHeader& expected, const std::string& filename)
+   {
+      MappedFile cache(cacheName);
+      if (!cache.isValid() || cache.size() < static_cast<qint64>(sizeof(CacheHeader)))
+      {
+         return NULL;
+      }
+      CacheHeader header;
+      memcpy(&header, cache.data(), sizeof(header));
+      if (header.mTag != expected.mTag || header.mMagic != expected.mMagic ||
+         header.mModified != expected.mModified || header.mSize != expected.mSize ||
+         header.mHash != expected.mHash || header.mPathLength != expected.mPathLength ||
+         cache.size() != static_cast<qint64>(sizeof(header) + header.mPathLength + header.mCodeLength) ||
+         memcmp(cache.data() + sizeof(header), filename.data(), header.mPathLength) != 0)
+      {
+         return NULL;
+      }
+      PyObject* pCode = PyMarshal_ReadObjectFromString(const_cast<char*>(cache.data()) +
+         sizeof(header) + header.mPathLength, header.mCodeLength);
+      if (pCode == NULL || !PyCode_Check(pCode))
+      {
+         // a damaged cache is rebuilt
+         Py_XDECREF(pCode);
+         PyErr_Clear();
+         return NULL;
+      }
+      return pCode;
+   }
+
+   void saveCache(const QString& cacheName, CacheHeader header, const std::string& filename, PyObject* pCode)
+   {
+      auto_obj marshalled(PyMarshal_WriteObjectToString(pCode, Py_MARSHAL_VERSION), true);
+      if (marshalled.get() == NULL)
+      {
+         PyErr_Clear();
+         return;
+      }
+      header.mCodeLength = static_cast<quint32>(PyString_GET_SIZE(marshalled.get()));
+
+      // write a temporary file and move it into place so a partial cache file is never read
+      QString tempName = cacheName + ".tmp";
+      QFile temp(tempName);
+      if (!temp.open(QFile::WriteOnly | QFile::Truncate))
+      {
+         return;
+      }
+      bool written = temp.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header) &&
+         temp.write(filename.data(), filename.size()) == static_cast<qint64>(filename.size()) &&
+         temp.write(PyString_AS_STRING(marshalled.get()), header.mCodeLength) == header.mCodeLength;
+      temp.close();
+      QFile::remove(cacheName);
+      if (!written || !QFile::rename(tempName, cacheName))
+      {
+         QFile::remove(tempName);
+      }
+   }
+}
+
+namespace ScriptCache
+{
+   PyObject* compileFile(const std::string& filename)
+   {
+      QString qFilename = QString::fromStdString(filename);
+      MappedFile script(qFilename);
+      if (!script.isValid())
+      {
+         PyErr_Format(PyExc_IOError, "Unable to read %s", filename.c_str());
+         return NULL;
+      }
+
+      CacheHeader header;
+      header.mTag = CACHE_TAG;
+      header.mMagic = static_cast<quint32>(PyImport_GetMagicNumber());
+      header.mModified = QFileInfo(qFilename).lastModified().toTime_t();
+      header.mSize = script.size();
+      header.mHash = hashBytes(script.data(), script.size());
+      header.mPathLength = static_cast<quint32>(filename.size());
+      header.mCodeLength = 0;
+
+      QString cacheName = cacheFilename(filename);
+      PyObject* pCode = loadCache(cacheName, header, filename);
+      if (pCode != NULL)
+      {
+         return pCode;
+      }
+
+      // the compiler needs a terminated string with \n line endings
+      std::string source;
+      source.reserve(static_cast<std::string::size_type>(script.size()) + 1);
+      for (const char* pChar = script.data(); pChar != script.data() + script.size(); ++pChar)
+      {
+         if (*pChar != '\r')
+         {
+            source += *pChar;
+         }
+         else if (pChar + 1 == script.data() + script.size() || pChar[1] != '\n')
+         {
+            source += '\n';
+         }
+      }
+      pCode = Py_CompileString(source.c_str(), filename.c_str(), Py_file_input);
+      if (pCode != NULL)
+      {
+         saveCache(cacheName, header, filename, pCode);
+      }
+      return pCode;
+   }
+
+   PyObject* compileSource(const std::string& source)
+   {
+      const unsigned int capacity = PythonInterpreter::getSettingScopedCodeCacheSize();
+      const quint64 hash = hashBytes(source.data(), source.size());
+      typedef std::multimap<quint64, CachedCodeList::iterator>::iterator IndexIterator;
+      std::pair<IndexIterator, IndexIterator> matches = sCachedCodeIndex.equal_range(hash);
+      for (IndexIterator pMatch = matches.first; pMatch != matches.second; ++pMatch)
+      {
+         CachedCodeList::iterator pCached = pMatch->second;
+         if (pCached->mSource == source)
+         {
+            ++sHits;
+            sCachedCode.splice(sCachedCode.begin(), sCachedCode, pCached);
+            Py_INCREF(pCached->mpCode);
+            return pCached->mpCode;
+         }
+      }
+
+      ++sMisses;
+      PyObject* pCode = Py_CompileString(source.c_str(), "<string>", Py_file_input);
+      if (pCode != NULL && capacity > 0)
+      {
+         CachedCode cached;
+         cached.mSource = source;
+         cached.mpCode = pCode;
+         Py_INCREF(pCode);
+         sCachedCode.push_front(cached);
+         sCachedCodeIndex.insert(std::make_pair(hash, sCachedCode.begin()));
+      }
+      evict(capacity);
+      return pCode;
+   }
+
+   void clear()
+   {
+      evict(0);
+   }
+
+   PyObject* code_cache_info(PyObject*, PyObject*)
+   {
+      return Py_BuildValue("(KKII)", sHits, sMisses, static_cast<unsigned int>(sCachedCode.size()),
+         PythonInterpreter::getSettingScopedCodeCacheSize());
+   }
+}
@@ -0,0 +1,65 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SCRIPTCACHE_H
+#define SCRIPTCACHE_H
+
+#include "PythonCommon.h"
+
+#include <string>
+
+/**
+ * Caches of compiled Python code.
+ *
+ * Script files are cached on disk.
+ * The code object for a script is marshalled to a file in the user storage directory, one
+ * cache file per script path and Python version. A cache file is only used if the script's
+ * path, modification time, size and a hash of its contents match those recorded when it
+ * was written and it was written by the same bytecode version. Otherwise the script is
+ * compiled again and the cache file is replaced. Scripts are memory mapped when possible.
+ *
+ * Command strings are cached in memory, keyed by a hash of the source and evicted least
+ * recently used first. The number of cached commands is set by PythonInterpreter's
+ * ScopedCodeCacheSize setting. The memory cache is only used with the GIL held.
+ */
+namespace ScriptCache
+{
+   /**
+    * Compile a Python script file, using the cached code object if the file has not changed.
+    * The caller must hold the GIL.
+    *
+    * @param filename
+    *        The full path of the script. This is used as the code object's file name.
+    *
+    * @return A new reference to the code object or NULL if a Python exception has been set.
+    */
+   PyObject* compileFile(const std::string& filename);
+
+   /**
+    * Compile Python source as a module, using a cached code object if the same source has
+    * been compiled recently. The caller must hold the GIL.
+    *
+    * @return A new reference to the code object or NULL if a Python exception has been set.
+    */
+   PyObject* compileSource(const std::string& source);
+
+   /**
+    * Release the code objects cached in memory. The caller must hold the GIL.
+    */
+   void clear();
+
+   /**
+    * code_cache_info() -> (hits, misses, entries, capacity)
+    *
+    * Report the use of the memory cache of compiled commands.
+    */
+   PyObject* code_cache_info(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "SimpleApiTable.h"
+
+namespace
+{
+   typedef int (*GetLastErrorFunc)();
+
+   GetLastErrorFunc spGetLastError = NULL;
+   PyObject* spErrorType = NULL;
+}
+
+namespace SimpleApiTable
+{
+   PyObject* set_error_source(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pAddress = NULL;
+      PyObject* pErrorType = NULL;
+      if (!PyArg_ParseTuple(pArgs, "OO", &pAddress, &pErrorType))
+      {
+         return NULL;
+      }
+      void* pFunc = PyLong_AsVoidPtr(pAddress);
+      if (pFunc == NULL)
+      {
+         if (!PyErr_Occurred())
+         {
+            PyErr_SetString(PyExc_ValueError, "Invalid getLastError address.");
+         }
+         return NULL;
+      }
+      if (!PyCallable_Check(pErrorType))
+      {
+         PyErr_SetString(PyExc_TypeError, "The exception type must be callable.");
+         return NULL;
+      }
+      Py_INCREF(pErrorType);
+      Py_XDECREF(spErrorType);
+      spErrorType = pErrorType;
+      spGetLastError = reinterpret_cast<GetLastErrorFunc>(pFunc);
+      Py_RETURN_NONE;
+   }
+
+   PyObject* error_check(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pResult = NULL;
+      PyObject* pFunc = NULL;
+      PyObject* pCallArgs = NULL;
+      if (!PyArg_ParseTuple(pArgs, "OOO", &pResult, &pFunc, &pCallArgs))
+      {
+         return NULL;
+      }
+      if (spGetLastError == NULL)
+      {
+         PyErr_SetString(PyExc_RuntimeError, "The SimpleApiLib error source has not been set.");
+         return NULL;
+      }
+      const int code = spGetLastError();
+      if (code != 0)
+      {
+         auto_obj pError(PyObject_CallFunction(spErrorType, const_cast<char*>("iO"), code, pResult), true);
+         if (pError.get() != NULL)
+         {
+            PyErr_SetObject(reinterpret_cast<PyObject*>(pError.get()->ob_type), pError.get());
+         }
+         return NULL;
+      }
+
+      // ctypes only uses the call's result if the same args object is returned
+      Py_INCREF(pCallArgs);
+      return pCallArgs;
+   }
+}
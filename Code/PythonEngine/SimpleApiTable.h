@@ -0,0 +1,40 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SIMPLEAPITABLE_H
+#define SIMPLEAPITABLE_H
+
+#include "PythonCommon.h"
+
+/**
+ * Native support for the ctypes bindings of the SimpleApiLib entry points.
+ *
+ * The opticks package loads SimpleApiLib with ctypes. Every checked call queries the
+ * library's last error afterwards so the check runs here, calling getLastError() through
+ * a function pointer which is resolved once instead of through a second ctypes call.
+ */
+namespace SimpleApiTable
+{
+   /**
+    * set_error_source(get_last_error_address, exception_type)
+    *
+    * Register the address of SimpleApiLib's getLastError() and the exception type
+    * which is raised with (code, result) when a call fails.
+    */
+   PyObject* set_error_source(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * error_check(result, func, args) -> args
+    *
+    * A ctypes errcheck function which raises the registered exception if the last call set an error.
+    */
+   PyObject* error_check(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
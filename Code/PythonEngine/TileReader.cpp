@@ -0,0 +1,312 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "Slot.h"
+#include "Subject.h"
+#include "TileReader.h"
+#include "TypesFile.h"
+
+#include <QtCore/QMutexLocker>
+
+#include <algorithm>
+#include <new>
+
+using RasterBuffer::SubCube;
+using RasterBuffer::ROW_DIM;
+using RasterBuffer::COLUMN_DIM;
+using RasterBuffer::BAND_DIM;
+
+TileReader::TileReader(RasterElement* pRaster, unsigned int tileRows, unsigned int tileColumns,
+                       unsigned int bandStart, unsigned int bandEnd, int interleave) :
+   mpRaster(pRaster),
+   mInterleave(interleave),
+   mTileRows(tileRows),
+   mTileColumns(tileColumns),
+   mBandStart(bandStart),
+   mBandEnd(bandEnd),
+   mItemSize(static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor())->getBytesPerElement()),
+   mDeleted(0),
+   mStop(false),
+   mFinished(false),
+   mTileReady(false),
+   mpReadyData(NULL)
+{
+   mpRaster->attach(SIGNAL_NAME(Subject, Deleted), Slot(this, &TileReader::elementDeleted));
+}
+
+TileReader::~TileReader()
+{
+   stop();
+   if (mDeleted.fetchAndStoreOrdered(1) == 0)
+   {
+      mpRaster->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &TileReader::elementDeleted));
+   }
+   delete [] mpReadyData;
+}
+
+bool TileReader::isDeleted() const
+{
+   return mDeleted != 0;
+}
+
+void TileReader::elementDeleted(Subject& subject, const std::string& signal, const boost::any& data)
+{
+   // the element is still valid during the notification, so a read in progress is allowed to finish
+   mDeleted.fetchAndStoreOrdered(1);
+   stop();
+}
+
+void TileReader::stop()
+{
+   mMutex.lock();
+   mStop = true;
+   mCondition.wakeAll();
+   mMutex.unlock();
+   wait();
+}
+
+bool TileReader::next(SubCube& tile, char*& pData)
+{
+   QMutexLocker lock(&mMutex);
+   while (!mTileReady && !mFinished && !mStop)
+   {
+      mCondition.wait(&mMutex);
+   }
+   if (!mTileReady || mStop)
+   {
+      return false;
+   }
+   tile = mReadyTile;
+   pData = mpReadyData;
+   mpReadyData = NULL;
+   mTileReady = false;
+   mCondition.wakeAll();
+   return true;
+}
+
+void TileReader::run()
+{
+   for (unsigned int index = 0; ; ++index)
+   {
+      SubCube tile;
+      if (!tileAt(index, tile))
+      {
+         break;
+      }
+      char* pData = new (std::nothrow) char[tile.count(ROW_DIM) * tile.count(COLUMN_DIM) *
+         tile.count(BAND_DIM) * mItemSize];
+      if (pData != NULL && !RasterBuffer::readSubCube(mpRaster, tile, mInterleave, pData))
+      {
+         delete [] pData;
+         pData = NULL;
+      }
+
+      // hand off the tile then wait until it is taken before reading the one after it
+      QMutexLocker lock(&mMutex);
+      while (mTileReady && !mStop)
+      {
+         mCondition.wait(&mMutex);
+      }
+      if (mStop)
+      {
+         delete [] pData;
+         return;
+      }
+      mReadyTile = tile;
+      mpReadyData = pData;
+      mTileReady = true;
+      mCondition.wakeAll();
+   }
+
+   QMutexLocker lock(&mMutex);
+   mFinished = true;
+   mCondition.wakeAll();
+}
+
+bool TileReader::tileAt(unsigned int index, SubCube& tile) const
+{
+   const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   const unsigned int rows = pDesc->getRowCount();
+   const unsigned int columns = pDesc->getColumnCount();
+   const unsigned int tilesPerRow = (columns + mTileColumns - 1) / mTileColumns;
+   const unsigned int tileRow = index / tilesPerRow;
+   const unsigned int tileColumn = index % tilesPerRow;
+   if (tileRow * mTileRows >= rows)
+   {
+      return false;
+   }
+   tile.mStart[ROW_DIM] = tileRow * mTileRows;
+   tile.mEnd[ROW_DIM] = std::min(rows, tile.mStart[ROW_DIM] + mTileRows) - 1;
+   tile.mStart[COLUMN_DIM] = tileColumn * mTileColumns;
+   tile.mEnd[COLUMN_DIM] = std::min(columns, tile.mStart[COLUMN_DIM] + mTileColumns) - 1;
+   tile.mStart[BAND_DIM] = mBandStart;
+   tile.mEnd[BAND_DIM] = mBandEnd;
+   tile.mStep[ROW_DIM] = 1;
+   tile.mStep[COLUMN_DIM] = 1;
+   tile.mStep[BAND_DIM] = 1;
+   return true;
+}
+
+namespace
+{
+   struct TileReaderObject
+   {
+      PyObject_HEAD
+      TileReader* mpReader;
+      RasterElement* mpRaster;
+      int mInterleave;
+   };
+
+   void tileReaderDealloc(TileReaderObject* pSelf)
+   {
+      if (pSelf->mpReader != NULL)
+      {
+         // the worker does not need the GIL so it is safe to wait for it here
+         Py_BEGIN_ALLOW_THREADS
+         delete pSelf->mpReader;
+         Py_END_ALLOW_THREADS
+      }
+      pSelf->ob_type->tp_free(reinterpret_cast<PyObject*>(pSelf));
+   }
+
+   PyObject* tileReaderIter(PyObject* pSelf)
+   {
+      Py_INCREF(pSelf);
+      return pSelf;
+   }
+
+   PyObject* tileReaderNext(TileReaderObject* pSelf)
+   {
+      SubCube tile;
+      char* pData = NULL;
+      bool haveTile = false;
+      Py_BEGIN_ALLOW_THREADS
+      haveTile = pSelf->mpReader->next(tile, pData);
+      Py_END_ALLOW_THREADS
+      if (pSelf->mpReader->isDeleted())
+      {
+         delete [] pData;
+         PyErr_SetString(PyExc_ValueError, "The raster element read by this TileReader has been destroyed.");
+         return NULL;
+      }
+      if (!haveTile)
+      {
+         return NULL; // StopIteration
+      }
+      if (pData == NULL)
+      {
+         PyErr_SetString(PyExc_RuntimeError, "Unable to read a tile of the raster element.");
+         return NULL;
+      }
+      PyObject* pBuffer = RasterBuffer::createBuffer(pSelf->mpRaster, tile, pSelf->mInterleave, pData);
+      if (pBuffer == NULL)
+      {
+         return NULL;
+      }
+      return Py_BuildValue("(IIN)", tile.mStart[ROW_DIM], tile.mStart[COLUMN_DIM], pBuffer);
+   }
+
+   PyTypeObject sTileReaderType = {
+      PyObject_HEAD_INIT(NULL)
+      0,                                                 // ob_size
+      "_opticks.TileReader",                             // tp_name
+      sizeof(TileReaderObject),                          // tp_basicsize
+      0,                                                 // tp_itemsize
+      reinterpret_cast<destructor>(tileReaderDealloc),   // tp_dealloc
+      0,                                                 // tp_print
+      0,                                                 // tp_getattr
+      0,                                                 // tp_setattr
+      0,                                                 // tp_compare
+      0,                                                 // tp_repr
+      0,                                                 // tp_as_number
+      0,                                                 // tp_as_sequence
+      0,                                                 // tp_as_mapping
+      0,                                                 // tp_hash
+      0,                                                 // tp_call
+      0,                                                 // tp_str
+      0,                                                 // tp_getattro
+      0,                                                 // tp_setattro
+      0,                                                 // tp_as_buffer
+      Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_ITER,         // tp_flags
+      "Iterates over the tiles of a raster element, reading ahead on a worker thread.", // tp_doc
+      0,                                                 // tp_traverse
+      0,                                                 // tp_clear
+      0,                                                 // tp_richcompare
+      0,                                                 // tp_weaklistoffset
+      tileReaderIter,                                    // tp_iter
+      reinterpret_cast<iternextfunc>(tileReaderNext)     // tp_iternext
+   };
+}
+
+namespace TileReaderModule
+{
+   bool registerType(PyObject* pModule)
+   {
+      if (PyType_Ready(&sTileReaderType) < 0)
+      {
+         return false;
+      }
+      Py_INCREF(&sTileReaderType);
+      return PyModule_AddObject(pModule, "TileReader", reinterpret_cast<PyObject*>(&sTileReaderType)) == 0;
+   }
+
+   PyObject* tile_reader(PyObject*, PyObject* pArgs)
+   {
+      PyObject* pHandle = NULL;
+      unsigned int tileRows = 0;
+      unsigned int tileColumns = 0;
+      int interleave = 0;
+      unsigned int bandStart = 0;
+      unsigned int bandEnd = 0;
+      if (!PyArg_ParseTuple(pArgs, "OIIiII", &pHandle, &tileRows, &tileColumns, &interleave, &bandStart, &bandEnd))
+      {
+         return NULL;
+      }
+      RasterElement* pRaster = RasterBuffer::toRasterElement(pHandle);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      if (tileRows == 0 || tileColumns == 0)
+      {
+         PyErr_SetString(PyExc_ValueError, "Tiles must contain at least one row and column.");
+         return NULL;
+      }
+      if (bandEnd < bandStart || bandEnd >= pDesc->getBandCount())
+      {
+         PyErr_SetString(PyExc_IndexError, "Band range is outside of the raster element.");
+         return NULL;
+      }
+      if (interleave != BSQ && interleave != BIP && interleave != BIL)
+      {
+         PyErr_SetString(PyExc_ValueError, "Invalid interleave.");
+         return NULL;
+      }
+      const int encoding = pDesc->getDataType();
+      if (encoding < INT1SBYTE || encoding > FLT8BYTES)
+      {
+         PyErr_SetString(PyExc_TypeError, "The raster element's encoding can't be represented.");
+         return NULL;
+      }
+
+      TileReaderObject* pReader = PyObject_New(TileReaderObject, &sTileReaderType);
+      if (pReader == NULL)
+      {
+         return NULL;
+      }
+      pReader->mpRaster = pRaster;
+      pReader->mInterleave = interleave;
+      pReader->mpReader = new TileReader(pRaster, tileRows, tileColumns, bandStart, bandEnd, interleave);
+      pReader->mpReader->start();
+      return reinterpret_cast<PyObject*>(pReader);
+   }
+}
@@ -0,0 +1,106 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TILEREADER_H
+#define TILEREADER_H
+
+#include "PythonCommon.h"
+#include "RasterBuffer.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <boost/any.hpp>
+#include <string>
+
+class RasterElement;
+class Subject;
+
+/**
+ * Reads a raster element a tile at a time on a worker thread.
+ *
+ * Tiles are visited in row major order. While the caller processes one tile,
+ * the worker thread reads the next one so I/O overlaps with computation.
+ * If the raster element is destroyed, the worker is stopped before the element goes away.
+ */
+class TileReader : public QThread
+{
+public:
+   TileReader(RasterElement* pRaster, unsigned int tileRows, unsigned int tileColumns,
+      unsigned int bandStart, unsigned int bandEnd, int interleave);
+   virtual ~TileReader();
+
+   /**
+    * Wait for the next tile. This does not use any Python objects so the GIL should be released.
+    *
+    * @param tile
+    *        Set to the sub-cube of the tile.
+    * @param pData
+    *        Set to the tile data which was allocated with new[]. The caller takes ownership.
+    *        This will be NULL if the tile could not be read.
+    *
+    * @return False if all tiles have been returned or the raster element has been destroyed.
+    */
+   bool next(RasterBuffer::SubCube& tile, char*& pData);
+
+   /**
+    * Has the raster element been destroyed? No more tiles are read once it has.
+    */
+   bool isDeleted() const;
+
+   void elementDeleted(Subject& subject, const std::string& signal, const boost::any& data);
+
+protected:
+   virtual void run();
+
+private:
+   TileReader(const TileReader& rhs);
+   TileReader& operator=(const TileReader& rhs);
+
+   bool tileAt(unsigned int index, RasterBuffer::SubCube& tile) const;
+   void stop();
+
+   RasterElement* mpRaster;
+   int mInterleave;
+   unsigned int mTileRows;
+   unsigned int mTileColumns;
+   unsigned int mBandStart;
+   unsigned int mBandEnd;
+   size_t mItemSize;
+   QAtomicInt mDeleted;
+
+   QMutex mMutex;
+   QWaitCondition mCondition;
+   bool mStop;
+   bool mFinished;
+   bool mTileReady;
+   RasterBuffer::SubCube mReadyTile;
+   char* mpReadyData;
+};
+
+namespace TileReaderModule
+{
+   /**
+    * Add the TileReader iterator type to a module.
+    *
+    * @return True on success, false if a Python exception has been set.
+    */
+   bool registerType(PyObject* pModule);
+
+   /**
+    * tile_reader(handle, tile_rows, tile_columns, interleave, band_start, band_end)
+    *
+    * Create an iterator which yields (row, column, RasterBuffer) for each tile of a raster element.
+    */
+   PyObject* tile_reader(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
@@ -0,0 +1,535 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DataVariant.h"
+#include "TypesFile.h"
+#include "VariantArray.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+   struct NativeType
+   {
+      const char* mpName;      // the DataVariant type name
+      char mKind;              // the numpy kind
+      Py_ssize_t mSize;
+      const char* mpFormat;    // the struct module format
+      PyObject* (*mpToPython)(const char* pValue);
+      bool (*mpFromPython)(PyObject* pObject, char* pValue);   // false if a Python exception has been set
+      char* (*mpVectorData)(void* pVector, Py_ssize_t& count);
+      DataVariant* (*mpCreate)(const char* pData, Py_ssize_t count, bool vector);
+   };
+
+   template<typename T>
+   PyObject* signedToPython(const char* pValue)
+   {
+      T value;
+      memcpy(&value, pValue, sizeof(T));
+      return PyInt_FromLong(static_cast<long>(value));
+   }
+
+   template<typename T>
+   PyObject* unsignedToPython(const char* pValue)
+   {
+      T value;
+      memcpy(&value, pValue, sizeof(T));
+      return PyInt_FromSize_t(static_cast<size_t>(value));
+   }
+
+   template<typename T>
+   PyObject* floatToPython(const char* pValue)
+   {
+      T value;
+      memcpy(&value, pValue, sizeof(T));
+      return PyFloat_FromDouble(static_cast<double>(value));
+   }
+
+   PyObject* int64ToPython(const char* pValue)
+   {
+      PY_LONG_LONG value;
+      memcpy(&value, pValue, sizeof(value));
+      return PyLong_FromLongLong(value);
+   }
+
+   PyObject* uint64ToPython(const char* pValue)
+   {
+      unsigned PY_LONG_LONG value;
+      memcpy(&value, pValue, sizeof(value));
+      return PyLong_FromUnsignedLongLong(value);
+   }
+
+   template<typename T>
+   bool signedFromPython(PyObject* pObject, char* pValue)
+   {
+      auto_obj number(PyNumber_Long(pObject), true);
+      if (number.get() == NULL)
+      {
+         return false;
+      }
+      const PY_LONG_LONG wide = PyLong_AsLongLong(number);
+      if (wide == -1 && PyErr_Occurred())
+      {
+         return false;
+      }
+      const T value = static_cast<T>(wide);
+      if (static_cast<PY_LONG_LONG>(value) != wide)
+      {
+         PyErr_SetString(PyExc_OverflowError, "The value is out of range for the vector's type.");
+         return false;
+      }
+      memcpy(pValue, &value, sizeof(T));
+      return true;
+   }
+
+   template<typename T>
+   bool unsignedFromPython(PyObject* pObject, char* pValue)
+   {
+      auto_obj number(PyNumber_Long(pObject), true);
+      if (number.get() == NULL)
+      {
+         return false;
+      }
+      const unsigned PY_LONG_LONG wide = PyLong_AsUnsignedLongLong(number);
+      if (wide == static_cast<unsigned PY_LONG_LONG>(-1) && PyErr_Occurred())
+      {
+         return false;
+      }
+      const T value = static_cast<T>(wide);
+      if (static_cast<unsigned PY_LONG_LONG>(value) != wide)
+      {
+         PyErr_SetString(PyExc_OverflowError, "The value is out of range for the vector's type.");
+         return false;
+      }
+      memcpy(pValue, &value, sizeof(T));
+      return true;
+   }
+
+   template<typename T>
+   bool floatFromPython(PyObject* pObject, char* pValue)
+   {
+      const double wide = PyFloat_AsDouble(pObject);
+      if (wide == -1.0 && PyErr_Occurred())
+      {
+         return false;
+      }
+      const T value = static_cast<T>(wide);
+      memcpy(pValue, &value, sizeof(T));
+      return true;
+   }
+
+   template<typename T>
+   char* vectorData(void* pVector, Py_ssize_t& count)
+   {
+      std::vector<T>& values = *reinterpret_cast<std::vector<T>*>(pVector);
+      count = static_cast<Py_ssize_t>(values.size());
+      return values.empty() ? NULL : reinterpret_cast<char*>(&values.front());
+   }
+
+   template<typename T>
+   DataVariant* createVariant(const char* pData, Py_ssize_t count, bool vector)
+   {
+      std::vector<T> values(count);
+      if (count > 0)
+      {
+         memcpy(&values.front(), pData, count * sizeof(T));
+      }
+      if (vector)
+      {
+         return new DataVariant(values);
+      }
+      return new DataVariant(values.front());
+   }
+
+#define NATIVE_TYPE(name, type, kind, format, convert, parse) \
+   {name, kind, sizeof(type), format, convert<type>, parse<type>, vectorData<type>, createVariant<type>}
+
+   // Int64 and UInt64 wrap a single 64 bit integer, so their values are converted through that integer
+#define WIDE_TYPE(name, type, storage, kind, format, convert, parse) \
+   {name, kind, sizeof(type), format, convert, parse<storage>, vectorData<type>, createVariant<type>}
+
+   // types of the same kind and size are listed in order of preference
+   const NativeType sNativeTypes[] = {
+      NATIVE_TYPE("char", char, 'i', "b", signedToPython, signedFromPython),
+      NATIVE_TYPE("unsigned char", unsigned char, 'u', "B", unsignedToPython, unsignedFromPython),
+      NATIVE_TYPE("short", short, 'i', "h", signedToPython, signedFromPython),
+      NATIVE_TYPE("unsigned short", unsigned short, 'u', "H", unsignedToPython, unsignedFromPython),
+      NATIVE_TYPE("int", int, 'i', "i", signedToPython, signedFromPython),
+      NATIVE_TYPE("unsigned int", unsigned int, 'u', "I", unsignedToPython, unsignedFromPython),
+      NATIVE_TYPE("long", long, 'i', "l", signedToPython, signedFromPython),
+      NATIVE_TYPE("unsigned long", unsigned long, 'u', "L", unsignedToPython, unsignedFromPython),
+      WIDE_TYPE("Int64", Int64, PY_LONG_LONG, 'i', "q", int64ToPython, signedFromPython),
+      WIDE_TYPE("UInt64", UInt64, unsigned PY_LONG_LONG, 'u', "Q", uint64ToPython, unsignedFromPython),
+      NATIVE_TYPE("float", float, 'f', "f", floatToPython, floatFromPython),
+      NATIVE_TYPE("double", double, 'f', "d", floatToPython, floatFromPython)
+   };
+
+#undef NATIVE_TYPE
+#undef WIDE_TYPE
+
+   /**
+    * Find the type of a scalar type name or of the items of a vector type name.
+    *
+    * @return The type or NULL if it isn't converted natively.
+    */
+   const NativeType* findType(const char* pTypeName, bool& vector)
+   {
+      std::string name(pTypeName);
+      vector = name.size() > 8 && name.compare(0, 7, "vector<") == 0 && name[name.size() - 1] == '>';
+      if (vector)
+      {
+         name = name.substr(7, name.size() - 8);
+      }
+      for (unsigned int i = 0; i < sizeof(sNativeTypes) / sizeof(sNativeTypes[0]); ++i)
+      {
+         if (name == sNativeTypes[i].mpName)
+         {
+            return &sNativeTypes[i];
+         }
+      }
+      return NULL;
+   }
+
+   bool isLittleEndian()
+   {
+      const int one = 1;
+      return *reinterpret_cast<const char*>(&one) == 1;
+   }
+
+   PyObject* typestr(const NativeType* pType)
+   {
+      const char byteOrder = (pType->mSize == 1) ? '|' : (isLittleEndian() ? '<' : '>');
+      return PyString_FromFormat("%c%c%d", byteOrder, pType->mKind, static_cast<int>(pType->mSize));
+   }
+
+   struct VariantArrayObject
+   {
+      PyObject_HEAD
+      char* mpData;
+      Py_ssize_t mCount;
+      const NativeType* mpType;
+      PyObject* mpOwner;       // kept alive for the lifetime of the view
+   };
+
+   // the address given to numpy for an empty vector
+   char sEmpty = 0;
+
+   void variantArrayDealloc(VariantArrayObject* pSelf)
+   {
+      Py_XDECREF(pSelf->mpOwner);
+      pSelf->ob_type->tp_free(reinterpret_cast<PyObject*>(pSelf));
+   }
+
+   Py_ssize_t variantArrayLength(VariantArrayObject* pSelf)
+   {
+      return pSelf->mCount;
+   }
+
+   PyObject* variantArrayItem(VariantArrayObject* pSelf, Py_ssize_t index)
+   {
+      if (index < 0 || index >= pSelf->mCount)
+      {
+         PyErr_SetString(PyExc_IndexError, "VariantArray index out of range.");
+         return NULL;
+      }
+      return pSelf->mpType->mpToPython(pSelf->mpData + index * pSelf->mpType->mSize);
+   }
+
+   int variantArrayAssignItem(VariantArrayObject* pSelf, Py_ssize_t index, PyObject* pValue)
+   {
+      if (index < 0 || index >= pSelf->mCount)
+      {
+         PyErr_SetString(PyExc_IndexError, "VariantArray index out of range.");
+         return -1;
+      }
+      if (pValue == NULL)
+      {
+         PyErr_SetString(PyExc_TypeError, "VariantArray items can't be deleted.");
+         return -1;
+      }
+      return pSelf->mpType->mpFromPython(pValue, pSelf->mpData + index * pSelf->mpType->mSize) ? 0 : -1;
+   }
+
+   Py_ssize_t variantArraySegmentCount(VariantArrayObject* pSelf, Py_ssize_t* pLength)
+   {
+      if (pLength != NULL)
+      {
+         *pLength = pSelf->mCount * pSelf->mpType->mSize;
+      }
+      return 1;
+   }
+
+   Py_ssize_t variantArrayGetBuffer(VariantArrayObject* pSelf, Py_ssize_t segment, void** pPtr)
+   {
+      if (segment != 0)
+      {
+         PyErr_SetString(PyExc_SystemError, "Accessing non-existent VariantArray segment.");
+         return -1;
+      }
+      *pPtr = pSelf->mpData;
+      return pSelf->mCount * pSelf->mpType->mSize;
+   }
+
+   Py_ssize_t variantArrayGetCharBuffer(VariantArrayObject* pSelf, Py_ssize_t segment, char** pPtr)
+   {
+      return variantArrayGetBuffer(pSelf, segment, reinterpret_cast<void**>(pPtr));
+   }
+
+#if PY_VERSION_HEX >= 0x02060000
+   int variantArrayGetNewBuffer(VariantArrayObject* pSelf, Py_buffer* pView, int flags)
+   {
+      pView->obj = reinterpret_cast<PyObject*>(pSelf);
+      Py_INCREF(pView->obj);
+      pView->buf = pSelf->mpData;
+      pView->len = pSelf->mCount * pSelf->mpType->mSize;
+      pView->readonly = 0;
+      pView->itemsize = pSelf->mpType->mSize;
+      pView->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? const_cast<char*>(pSelf->mpType->mpFormat) : NULL;
+      pView->ndim = 1;
+      pView->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? &pSelf->mCount : NULL;
+      pView->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? const_cast<Py_ssize_t*>(&pSelf->mpType->mSize) : NULL;
+      pView->suboffsets = NULL;
+      pView->internal = NULL;
+      return 0;
+   }
+#endif
+
+   PyObject* variantArrayArrayInterface(VariantArrayObject* pSelf, void*)
+   {
+      auto_obj pTypeStr(typestr(pSelf->mpType), true);
+      if (pTypeStr.get() == NULL)
+      {
+         return NULL;
+      }
+      void* pData = (pSelf->mpData == NULL) ? &sEmpty : pSelf->mpData;
+      return Py_BuildValue("{s:(n),s:O,s:[(sO)],s:(NO),s:i}",
+         "shape", pSelf->mCount,
+         "typestr", pTypeStr.get(),
+         "descr", "", pTypeStr.get(),
+         "data", PyLong_FromVoidPtr(pData), Py_False,
+         "version", 3);
+   }
+
+   PyObject* variantArrayGetTypeName(VariantArrayObject* pSelf, void*)
+   {
+      return PyString_FromFormat("vector<%s>", pSelf->mpType->mpName);
+   }
+
+   PyGetSetDef sVariantArrayGetSet[] = {
+      {const_cast<char*>("__array_interface__"), reinterpret_cast<getter>(variantArrayArrayInterface), NULL,
+         const_cast<char*>("The numpy array interface for this vector."), NULL},
+      {const_cast<char*>("type_name"), reinterpret_cast<getter>(variantArrayGetTypeName), NULL,
+         const_cast<char*>("The DataVariant type name of the vector."), NULL},
+      {NULL, NULL, NULL, NULL, NULL} // sentinel
+   };
+
+   PySequenceMethods sVariantArraySequence = {
+      reinterpret_cast<lenfunc>(variantArrayLength),   // sq_length
+      0,                                                 // sq_concat
+      0,                                                 // sq_repeat
+      reinterpret_cast<ssizeargfunc>(variantArrayItem), // sq_item
+      0,                                                 // sq_slice
+      reinterpret_cast<ssizeobjargproc>(variantArrayAssignItem) // sq_ass_item
+   };
+
+   PyBufferProcs sVariantArrayProcs = {
+      reinterpret_cast<readbufferproc>(variantArrayGetBuffer),
+      reinterpret_cast<writebufferproc>(variantArrayGetBuffer),
+      reinterpret_cast<segcountproc>(variantArraySegmentCount),
+      reinterpret_cast<charbufferproc>(variantArrayGetCharBuffer)
+#if PY_VERSION_HEX >= 0x02060000
+      , reinterpret_cast<getbufferproc>(variantArrayGetNewBuffer),
+      NULL
+#endif
+   };
+
+#if PY_VERSION_HEX >= 0x02060000
+#define VARIANTARRAY_TPFLAGS (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER)
+#else
+#define VARIANTARRAY_TPFLAGS Py_TPFLAGS_DEFAULT
+#endif
+
+   PyTypeObject sVariantArrayType = {
+      PyObject_HEAD_INIT(NULL)
+      0,                                                 // ob_size
+      "_opticks.VariantArray",                           // tp_name
+      sizeof(VariantArrayObject),                        // tp_basicsize
+      0,                                                 // tp_itemsize
+      reinterpret_cast<destructor>(variantArrayDealloc), // tp_dealloc
+      0,                                                 // tp_print
+      0,                                                 // tp_getattr
+      0,                                                 // tp_setattr
+      0,                                                 // tp_compare
+      0,                                                 // tp_repr
+      0,                                                 // tp_as_number
+      &sVariantArraySequence,                            // tp_as_sequence
+      0,                                                 // tp_as_mapping
+      0,                                                 // tp_hash
+      0,                                                 // tp_call
+      0,                                                 // tp_str
+      0,                                                 // tp_getattro
+      0,                                                 // tp_setattro
+      &sVariantArrayProcs,                               // tp_as_buffer
+      VARIANTARRAY_TPFLAGS,                              // tp_flags
+      "A writable view of a DataVariant vector. Use numpy.asarray() to access the data.", // tp_doc
+      0,                                                 // tp_traverse
+      0,                                                 // tp_clear
+      0,                                                 // tp_richcompare
+      0,                                                 // tp_weaklistoffset
+      0,                                                 // tp_iter
+      0,                                                 // tp_iternext
+      0,                                                 // tp_methods
+      0,                                                 // tp_members
+      sVariantArrayGetSet                                // tp_getset
+   };
+}
+
+namespace VariantArray
+{
+   bool registerType(PyObject* pModule)
+   {
+      if (PyType_Ready(&sVariantArrayType) < 0)
+      {
+         return false;
+      }
+      Py_INCREF(&sVariantArrayType);
+      return PyModule_AddObject(pModule, "VariantArray", reinterpret_cast<PyObject*>(&sVariantArrayType)) == 0;
+   }
+
+   PyObject* copyValue(const std::string& typeName, const void* pValue)
+   {
+      bool vector = false;
+      const NativeType* pType = findType(typeName.c_str(), vector);
+      if (pType == NULL || pValue == NULL)
+      {
+         return NULL;
+      }
+      if (!vector)
+      {
+         return pType->mpToPython(reinterpret_cast<const char*>(pValue));
+      }
+      Py_ssize_t count = 0;
+      const char* pData = pType->mpVectorData(const_cast<void*>(pValue), count);
+      PyObject* pList = PyList_New(count);
+      for (Py_ssize_t i = 0; pList != NULL && i < count; ++i)
+      {
+         PyObject* pItem = pType->mpToPython(pData + i * pType->mSize);
+         if (pItem == NULL)
+         {
+            Py_DECREF(pList);
+            return NULL;
+         }
+         PyList_SET_ITEM(pList, i, pItem);
+      }
+      return pList;
+   }
+
+   PyObject* native_value(PyObject*, PyObject* pArgs)
+   {
+      const char* pTypeName = NULL;
+      PyObject* pAddress = NULL;
+      PyObject* pOwner = Py_None;
+      if (!PyArg_ParseTuple(pArgs, "sO|O", &pTypeName, &pAddress, &pOwner))
+      {
+         return NULL;
+      }
+      bool vector = false;
+      const NativeType* pType = findType(pTypeName, vector);
+      void* pValue = (pAddress == Py_None) ? NULL : PyLong_AsVoidPtr(pAddress);
+      if (PyErr_Occurred())
+      {
+         return NULL;
+      }
+      if (pType == NULL || pValue == NULL)
+      {
+         Py_RETURN_NONE;
+      }
+      if (!vector)
+      {
+         return pType->mpToPython(reinterpret_cast<const char*>(pValue));
+      }
+
+      VariantArrayObject* pArray = PyObject_New(VariantArrayObject, &sVariantArrayType);
+      if (pArray == NULL)
+      {
+         return NULL;
+      }
+      pArray->mpData = pType->mpVectorData(pValue, pArray->mCount);
+      pArray->mpType = pType;
+      pArray->mpOwner = pOwner;
+      Py_INCREF(pOwner);
+      return reinterpret_cast<PyObject*>(pArray);
+   }
+
+   PyObject* variant_from_array(PyObject*, PyObject* pArgs)
+   {
+      const char* pTypeName = NULL;
+      PyObject* pBuffer = NULL;
+      if (!PyArg_ParseTuple(pArgs, "sO", &pTypeName, &pBuffer))
+      {
+         return NULL;
+      }
+      bool vector = false;
+      const NativeType* pType = findType(pTypeName, vector);
+      if (pType == NULL)
+      {
+         PyErr_Format(PyExc_TypeError, "%s can't be created from an array.", pTypeName);
+         return NULL;
+      }
+      const void* pData = NULL;
+      Py_ssize_t length = 0;
+      if (PyObject_AsReadBuffer(pBuffer, &pData, &length) != 0)
+      {
+         return NULL;
+      }
+      const Py_ssize_t count = length / pType->mSize;
+      if (length % pType->mSize != 0 || (!vector && count != 1))
+      {
+         PyErr_Format(PyExc_ValueError, "The buffer does not hold %s.", vector ? "whole items" : "one item");
+         return NULL;
+      }
+      DataVariant* pVariant = pType->mpCreate(reinterpret_cast<const char*>(pData), count, vector);
+      return PyLong_FromVoidPtr(pVariant);
+   }
+
+   PyObject* native_format(PyObject*, PyObject* pArgs)
+   {
+      const char* pTypeName = NULL;
+      if (!PyArg_ParseTuple(pArgs, "s", &pTypeName))
+      {
+         return NULL;
+      }
+      bool vector = false;
+      const NativeType* pType = findType(pTypeName, vector);
+      if (pType == NULL)
+      {
+         Py_RETURN_NONE;
+      }
+      return PyString_FromString(pType->mpFormat);
+   }
+
+   PyObject* native_type_name(PyObject*, PyObject* pArgs)
+   {
+      const char* pFormat = NULL;
+      if (!PyArg_ParseTuple(pArgs, "s", &pFormat))
+      {
+         return NULL;
+      }
+      for (unsigned int i = 0; i < sizeof(sNativeTypes) / sizeof(sNativeTypes[0]); ++i)
+      {
+         if (strcmp(sNativeTypes[i].mpFormat, pFormat) == 0)
+         {
+            return PyString_FromString(sNativeTypes[i].mpName);
+         }
+      }
+      Py_RETURN_NONE;
+   }
+}
@@ -0,0 +1,82 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef VARIANTARRAY_H
+#define VARIANTARRAY_H
+
+#include "PythonCommon.h"
+
+#include <string>
+
+/**
+ * Native conversion between DataVariant values and Python numbers and numpy arrays.
+ *
+ * Values are described by their DataVariant type name, such as "double" or "vector<double>".
+ * The numeric types and vectors of them are converted here; other types return None so the
+ * caller can fall back to the general conversion in the opticks package.
+ *
+ * A vector is returned as a VariantArray, a writable view of the vector's storage which
+ * supports the buffer protocol, the numpy array interface and indexing. Items can be changed through the view, but the vector
+ * can't be resized. The view keeps a reference to an owner object, normally the Python wrapper
+ * of the value, but the vector itself must not be resized or destroyed while the view exists.
+ */
+namespace VariantArray
+{
+   /**
+    * Add the VariantArray type to a module.
+    *
+    * @return True on success, false if a Python exception has been set.
+    */
+   bool registerType(PyObject* pModule);
+
+   /**
+    * Copy a number or a vector of numbers to a Python number or list.
+    *
+    * @param typeName
+    *        The DataVariant type name of the value.
+    * @param pValue
+    *        The address of the value.
+    *
+    * @return A new reference or NULL. If the type is not numeric, no exception is set.
+    */
+   PyObject* copyValue(const std::string& typeName, const void* pValue);
+
+   /**
+    * native_value(type_name, address, owner) -> value or None
+    *
+    * Convert the value of a type at an address to a Python number or a VariantArray.
+    */
+   PyObject* native_value(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * variant_from_array(type_name, buffer) -> address
+    *
+    * Create a DataVariant from the items in a buffer, which must be in the native
+    * layout of the type. A scalar type needs exactly one item. The caller owns the
+    * new DataVariant.
+    */
+   PyObject* variant_from_array(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * native_format(type_name) -> format or None
+    *
+    * The struct module format of a type or of the items of a vector type. This is also
+    * the array module type code and a numpy dtype character.
+    */
+   PyObject* native_format(PyObject* pSelf, PyObject* pArgs);
+
+   /**
+    * native_type_name(format) -> type_name or None
+    *
+    * The DataVariant type name which stores items of a struct module format.
+    */
+   PyObject* native_type_name(PyObject* pSelf, PyObject* pArgs);
+}
+
+#endif
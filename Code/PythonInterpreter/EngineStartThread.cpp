@@ -0,0 +1,45 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "EngineStartThread.h"
+#include "PythonInterpreter.h"
+#include "PythonInterpreterManager.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+
+namespace
+{
+   const QEvent::Type sStartedEvent = static_cast<QEvent::Type>(QEvent::registerEventType());
+}
+
+EngineStartThread::EngineStartThread(PythonInterpreter* pInterpreter, PythonInterpreterManager* pManager) :
+   mpInterpreter(pInterpreter),
+   mpManager(pManager)
+{
+}
+
+EngineStartThread::~EngineStartThread()
+{
+   wait();
+}
+
+void EngineStartThread::run()
+{
+   mpInterpreter->runUserFile();
+   QCoreApplication::postEvent(this, new QEvent(sStartedEvent));
+}
+
+void EngineStartThread::customEvent(QEvent* pEvent)
+{
+   if (pEvent->type() == sStartedEvent)
+   {
+      mpManager->finishBackgroundStart();
+   }
+}
@@ -0,0 +1,41 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef ENGINESTARTTHREAD_H
+#define ENGINESTARTTHREAD_H
+
+#include <QtCore/QThread>
+
+class PythonInterpreter;
+class PythonInterpreterManager;
+
+/**
+ * Imports the Python interpreter and runs the user file on a worker thread so the application
+ * does not wait for them.
+ *
+ * Python must already be initialized on the thread which created this object, normally the
+ * GUI thread, so Python's signal handlers are installed there. When the user file has finished,
+ * the manager is told from that thread so it can finish starting the engine there.
+ */
+class EngineStartThread : public QThread
+{
+public:
+   EngineStartThread(PythonInterpreter* pInterpreter, PythonInterpreterManager* pManager);
+   virtual ~EngineStartThread();
+
+protected:
+   virtual void run();
+   virtual void customEvent(QEvent* pEvent);
+
+private:
+   PythonInterpreter* mpInterpreter;
+   PythonInterpreterManager* mpManager;
+};
+
+#endif
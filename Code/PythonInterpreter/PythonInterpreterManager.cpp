@@ -9,6 +9,7 @@
 
 #include "AppVerify.h"
 #include "DynamicModule.h"
+#include "EngineStartThread.h"
 #include "MessageLogResource.h"
 #include "PlugInArgList.h"
 #include "PlugInRegistration.h"
@@ -23,7 +24,8 @@ PythonInterpreterManager::PythonInterpreterManager() :
    mpAppServices(Service<ApplicationServices>().get()),
    mAppShuttingDown(false),
    mpModule(NULL),
-   mpInterpreter(NULL)
+   mpInterpreter(NULL),
+   mpStartThread(NULL)
 {
    setName("Python");
    setDescription("Provides command line utilities to execute Python commands.");
@@ -35,6 +37,8 @@ PythonInterpreterManager::PythonInterpreterManager() :
    setFileExtensions("Python Scripts (*.py *.pyw)");
    setWizardSupported(false);
    setInteractiveEnabled(PythonInterpreter::getSettingInteractiveAvailable());
+   executeOnStartup(PythonInterpreter::getSettingPrewarmEngine());
+   destroyAfterExecute(!PythonInterpreter::getSettingPrewarmEngine());
    mpAppServices.addSignal(SIGNAL_NAME(ApplicationServices, ApplicationClosed),
       Slot(this, &PythonInterpreterManager::applicationClosed)), 
 
@@ -309,8 +313,18 @@ PythonInterpreterManager::PythonInterpreterManager() :
       "OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.</pre>");
 }
 
+PythonInterpreterManager::~PythonInterpreterManager()
+{
+   delete mpStartThread;
+}
+
 bool PythonInterpreterManager::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
 {
+   if (PythonInterpreter::getSettingPrewarmEngine())
+   {
+      // executed at application startup, only Python's initialization blocks the application
+      return startInBackground();
+   }
    start();
    return true;
 }
@@ -322,11 +336,62 @@ bool PythonInterpreterManager::isStarted() const
 
 bool PythonInterpreterManager::start()
 {
-   bool alreadyStarted = false;
    if (mAppShuttingDown)
    {
       return false;
    }
+   finishBackgroundStart();
+   bool alreadyStarted = isStarted();
+   if (!loadEngine())
+   {
+      return false;
+   }
+
+   bool started = mpInterpreter->startPython();
+   if (!alreadyStarted && started)
+   {
+      notify(SIGNAL_NAME(InterpreterManager, InterpreterStarted));
+   }
+   return started;
+}
+
+bool PythonInterpreterManager::startInBackground()
+{
+   if (mAppShuttingDown)
+   {
+      return false;
+   }
+   if (mpStartThread != NULL || isStarted())
+   {
+      return true;
+   }
+   if (!loadEngine() || !mpInterpreter->initializePython())
+   {
+      return false;
+   }
+   mpStartThread = new EngineStartThread(mpInterpreter, this);
+   mpStartThread->start();
+   return true;
+}
+
+void PythonInterpreterManager::finishBackgroundStart()
+{
+   if (mpStartThread == NULL)
+   {
+      return;
+   }
+   mpStartThread->wait();
+   // this may be called while the thread object is handling an event so it can't be deleted here
+   mpStartThread->deleteLater();
+   mpStartThread = NULL;
+   if (mpInterpreter->startPython())
+   {
+      notify(SIGNAL_NAME(InterpreterManager, InterpreterStarted));
+   }
+}
+
+bool PythonInterpreterManager::loadEngine()
+{
    if (mpModule == NULL)
    {
       //if we haven't loaded PythonEngine dynamic library and retrieved PythonInterpreter
@@ -375,29 +440,26 @@ bool PythonInterpreterManager::start()
          mStartupMessage = "Unknown problem occurred loading " + pyEnginePath;
       }
    }
-   else if (mpInterpreter != NULL)
-   {
-      alreadyStarted = mpInterpreter->isPythonRunning();
-   }
-
-   if (mpInterpreter == NULL)
-   {
-      return false;
-   }
-   
-   bool started = mpInterpreter->startPython();
-   if (!alreadyStarted && started)
-   {
-      notify(SIGNAL_NAME(InterpreterManager, InterpreterStarted));
-   }
-   return started;
+   return mpInterpreter != NULL;
 }
 
 void PythonInterpreterManager::applicationClosed(Subject& subject, const std::string& signal, const boost::any& data)
 {
    mAppShuttingDown = true;
+   delete mpStartThread;
+   mpStartThread = NULL;
    if (mpModule != NULL)
    {
+      bool (*python_engine_busy)() =
+         reinterpret_cast<bool(*)()>(mpModule->getProcedureAddress("python_engine_busy"));
+      if (python_engine_busy != NULL && python_engine_busy())
+      {
+         // a caller further up the stack is waiting for a command, so the engine and its
+         // module are left to be released with the process
+         mpInterpreter = NULL;
+         mpModule = NULL;
+         return;
+      }
       void (*shutdown_python_engine)() = 
          reinterpret_cast<void(*)()>(mpModule->getProcedureAddress("shutdown_python_engine"));
       if (shutdown_python_engine != NULL)
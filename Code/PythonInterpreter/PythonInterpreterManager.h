@@ -17,13 +17,14 @@
 #include <string>
 
 class DynamicModule;
+class EngineStartThread;
 class PythonInterpreter;
 
 class PythonInterpreterManager : public InterpreterManagerShell, public SubjectImp
 {
 public:
    PythonInterpreterManager();
-   virtual ~PythonInterpreterManager() {}
+   virtual ~PythonInterpreterManager();
 
    virtual bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
 
@@ -32,6 +33,22 @@ public:
    virtual std::string getStartupMessage() const;
    virtual Interpreter* getInterpreter() const;
 
+   /**
+    * Load the engine and initialize Python on the calling thread, then import the interpreter
+    * and run the user file on a worker thread. The user file must not use the GUI when it is run
+    * this way. InterpreterStarted is notified from the calling thread once Python is running.
+    * A call to start() while the engine is starting waits for it to finish.
+    *
+    * @return False if the engine could not be loaded.
+    */
+   bool startInBackground();
+
+   /**
+    * Wait for a background start to finish, finish starting the engine and notify InterpreterStarted if it succeeded.
+    * Nothing happens if there is no background start.
+    */
+   void finishBackgroundStart();
+
    virtual const std::string& getObjectType() const;
    virtual bool isKindOf(const std::string& className) const;
 
@@ -40,10 +57,12 @@ public:
 private:
    AttachmentPtr<ApplicationServices> mpAppServices;
    void applicationClosed(Subject& subject, const std::string& signal, const boost::any& data);
+   bool loadEngine();
 
    bool mAppShuttingDown;
    DynamicModule* mpModule;
    PythonInterpreter* mpInterpreter;
+   EngineStartThread* mpStartThread;
    std::string mStartupMessage;
 };
 #endif
@@ -16,8 +16,10 @@
 #include "PlugInRegistration.h"
 #include "PythonInterpreterOptions.h"
 #include "PythonInterpreter.h"
+#include <QtGui/QCheckBox>
 #include <QtGui/QLabel>
 #include <QtGui/QLineEdit>
+#include <QtGui/QSpinBox>
 #include <QtGui/QWidget>
 
 REGISTER_PLUGIN(Python, PythonInterpreterOptions, OptionQWidgetWrapper<PythonInterpreterOptions>());
@@ -32,14 +34,30 @@ PythonInterpreterOptions::PythonInterpreterOptions()
    
    QLabel* pPythonHomeLabel = new QLabel("Python Home Location", pPythonConfigWidget);
    mpPythonHome = new QLineEdit(pPythonConfigWidget);
+   mpPrewarmEngine = new QCheckBox("Start Python in the background when the application starts", pPythonConfigWidget);
+   mpPrewarmEngine->setToolTip("Python is ready when it is first needed. The user configuration file is run on a background thread "
+      "and must not use the GUI. This takes effect the next time the application starts.");
+   mpBackgroundExecution = new QCheckBox("Run Python commands on a background thread", pPythonConfigWidget);
+   mpBackgroundExecution->setToolTip("Keep the application repainting while long running commands and scripts execute. "
+      "User input is held until a command finishes. Commands run this way must not create, change or "
+      "close views, layers, widgets or other GUI objects since they are not called on the main thread.");
+   QLabel* pCodeCacheLabel = new QLabel("Compiled Command Cache Size", pPythonConfigWidget);
+   mpCodeCacheSize = new QSpinBox(pPythonConfigWidget);
+   mpCodeCacheSize->setRange(0, 10000);
+   mpCodeCacheSize->setSpecialValueText("Disabled");
+   mpCodeCacheSize->setToolTip("The number of recently run commands which are kept compiled so they are not parsed again.");
 
    QGridLayout* pPythonConfigLayout = new QGridLayout(pPythonConfigWidget);
    pPythonConfigLayout->addWidget(pUserConfLabel, 0, 0);
    pPythonConfigLayout->addWidget(mpUserConfig, 0, 1);
    pPythonConfigLayout->addWidget(pPythonHomeLabel, 1, 0);
    pPythonConfigLayout->addWidget(mpPythonHome, 1, 1);
+   pPythonConfigLayout->addWidget(mpPrewarmEngine, 2, 0, 1, 2);
+   pPythonConfigLayout->addWidget(mpBackgroundExecution, 3, 0, 1, 2);
+   pPythonConfigLayout->addWidget(pCodeCacheLabel, 4, 0);
+   pPythonConfigLayout->addWidget(mpCodeCacheSize, 4, 1, Qt::AlignLeft);
    pPythonConfigLayout->setColumnStretch(1, 10);
-   pPythonConfigLayout->setRowStretch(2, 10);
+   pPythonConfigLayout->setRowStretch(5, 10);
 
    LabeledSection* pPythonConfigSection = new LabeledSection(pPythonConfigWidget, "Python Configuration", this);
 
@@ -51,6 +69,9 @@ PythonInterpreterOptions::PythonInterpreterOptions()
    setUserFile(pTmpFile);
    
    mpPythonHome->setText(QString::fromStdString(PythonInterpreter::getSettingPythonHome()));
+   mpPrewarmEngine->setChecked(PythonInterpreter::getSettingPrewarmEngine());
+   mpBackgroundExecution->setChecked(PythonInterpreter::getSettingBackgroundExecution());
+   mpCodeCacheSize->setValue(static_cast<int>(PythonInterpreter::getSettingScopedCodeCacheSize()));
 }
 
 PythonInterpreterOptions::~PythonInterpreterOptions()
@@ -71,4 +92,7 @@ void PythonInterpreterOptions::applyChanges()
    pTmpFile->setFullPathAndName(mpUserConfig->getFilename().toStdString());
    PythonInterpreter::setSettingUserFile(pTmpFile.get());
    PythonInterpreter::setSettingPythonHome(mpPythonHome->text().toStdString());
+   PythonInterpreter::setSettingPrewarmEngine(mpPrewarmEngine->isChecked());
+   PythonInterpreter::setSettingBackgroundExecution(mpBackgroundExecution->isChecked());
+   PythonInterpreter::setSettingScopedCodeCacheSize(static_cast<unsigned int>(mpCodeCacheSize->value()));
 }
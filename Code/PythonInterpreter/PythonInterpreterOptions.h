@@ -17,7 +17,9 @@
 #include <vector>
 
 class FileBrowser;
+class QCheckBox;
 class QLineEdit;
+class QSpinBox;
 
 class PythonInterpreterOptions : public LabeledSectionGroup
 {
@@ -86,6 +88,9 @@ public:
 private:
    FileBrowser* mpUserConfig;
    QLineEdit* mpPythonHome;
+   QCheckBox* mpPrewarmEngine;
+   QCheckBox* mpBackgroundExecution;
+   QSpinBox* mpCodeCacheSize;
 };
 
 #endif
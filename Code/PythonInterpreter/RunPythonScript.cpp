@@ -0,0 +1,125 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DynamicObject.h"
+#include "Filename.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "PlugInRegistration.h"
+#include "Progress.h"
+#include "PythonInterpreter.h"
+#include "PythonInterpreterManager.h"
+#include "PythonVersion.h"
+#include "RunPythonScript.h"
+#include "Slot.h"
+
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(Python, RunPythonScript);
+
+RunPythonScript::RunPythonScript()
+{
+   setName("Run Python Script");
+   setDescription("Runs a Python script file, passing it the plug-in's input and output arguments.");
+   setDescriptorId("{962689af-4d51-4f39-bbfd-b0462cf2b391}");
+   setCopyright(PYTHON_COPYRIGHT);
+   setVersion(PYTHON_VERSION_NUMBER);
+   setProductionStatus(PYTHON_IS_PRODUCTION_RELEASE);
+   setType("Python");
+   setAbortSupported(true);
+}
+
+RunPythonScript::~RunPythonScript()
+{
+}
+
+bool RunPythonScript::getInputSpecification(PlugInArgList*& pArgList)
+{
+   VERIFY((pArgList = Service<PlugInManagerServices>()->getPlugInArgList()) != NULL);
+   VERIFY(pArgList->addArg<Progress>(Executable::ProgressArg(), NULL, Executable::ProgressArgDescription()));
+   VERIFY(pArgList->addArg<Filename>("Script", NULL, "The Python script file to run."));
+   VERIFY(pArgList->addArg<DynamicObject>("Parameters", NULL,
+      "Values for the script, available as inputs[\"Parameters\"].value."));
+   return true;
+}
+
+bool RunPythonScript::getOutputSpecification(PlugInArgList*& pArgList)
+{
+   VERIFY((pArgList = Service<PlugInManagerServices>()->getPlugInArgList()) != NULL);
+   VERIFY(pArgList->addArg<DynamicObject>("Results", NULL,
+      "The values the script stored in results. The caller owns this object."));
+   VERIFY(pArgList->addArg<std::string>("Output", NULL, "Text the script wrote to sys.stdout."));
+   return true;
+}
+
+bool RunPythonScript::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
+{
+   VERIFY(pInArgList != NULL && pOutArgList != NULL);
+   Progress* pProgress = pInArgList->getPlugInArgValue<Progress>(Executable::ProgressArg());
+   Filename* pScript = pInArgList->getPlugInArgValue<Filename>("Script");
+   if (pScript == NULL)
+   {
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress("No Python script was specified.", 0, ERRORS);
+      }
+      return false;
+   }
+
+   std::vector<PlugIn*> plugins = Service<PlugInManagerServices>()->getPlugInInstances("Python");
+   PythonInterpreterManager* pInterMgr =
+      plugins.size() == 1 ? dynamic_cast<PythonInterpreterManager*>(plugins.front()) : NULL;
+   if (pInterMgr == NULL || !pInterMgr->start())
+   {
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress("Unable to start the Python engine. " +
+            (pInterMgr == NULL ? std::string() : pInterMgr->getStartupMessage()), 0, ERRORS);
+      }
+      return false;
+   }
+   // the manager's interpreter is always the engine's PythonInterpreter
+   PythonInterpreter* pInterpreter = static_cast<PythonInterpreter*>(pInterMgr->getInterpreter());
+   VERIFY(pInterpreter != NULL);
+
+   FactoryResource<DynamicObject> pResults;
+   mOutput.clear();
+   mError.clear();
+   bool success = pInterpreter->executeScript(pScript->getFullPathAndName(), pInArgList, pOutArgList,
+      pResults.get(), Slot(this, &RunPythonScript::gatherOutput), Slot(this, &RunPythonScript::gatherError),
+      pProgress);
+
+   pOutArgList->setPlugInArgValue("Output", &mOutput);
+   if (!success)
+   {
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress(mError.empty() ? "The Python script failed." : mError, 0, ERRORS);
+      }
+      return false;
+   }
+   pOutArgList->setPlugInArgValue("Results", pResults.release());
+   if (pProgress != NULL)
+   {
+      pProgress->updateProgress("The Python script is complete.", 100, NORMAL);
+   }
+   return true;
+}
+
+void RunPythonScript::gatherOutput(Subject& subject, const std::string& signal, const boost::any& data)
+{
+   mOutput += boost::any_cast<std::string>(data);
+}
+
+void RunPythonScript::gatherError(Subject& subject, const std::string& signal, const boost::any& data)
+{
+   mError += boost::any_cast<std::string>(data);
+}
@@ -0,0 +1,45 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef RUNPYTHONSCRIPT_H
+#define RUNPYTHONSCRIPT_H
+
+#include "ExecutableShell.h"
+
+#include <boost/any.hpp>
+#include <string>
+
+class Subject;
+
+/**
+ * Runs a Python script file from a wizard or another plug-in.
+ *
+ * The script runs as a scoped command with its own globals. It sees its input and output
+ * argument lists as the opticks.PlugInArgList objects inputs and outputs and stores values
+ * for later steps in results, an opticks.DynamicObject which becomes the Results output.
+ */
+class RunPythonScript : public ExecutableShell
+{
+public:
+   RunPythonScript();
+   virtual ~RunPythonScript();
+
+   virtual bool getInputSpecification(PlugInArgList*& pArgList);
+   virtual bool getOutputSpecification(PlugInArgList*& pArgList);
+   virtual bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
+
+private:
+   void gatherOutput(Subject& subject, const std::string& signal, const boost::any& data);
+   void gatherError(Subject& subject, const std::string& signal, const boost::any& data);
+
+   std::string mOutput;
+   std::string mError;
+};
+
+#endif
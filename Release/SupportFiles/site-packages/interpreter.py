@@ -1,11 +1,9 @@
 """Python side interactive interpreter support"""
 from code import InteractiveInterpreter
 import sys
-import StringIO
+import types
+import __builtin__
 import _opticks
-import ctypes
-import tokenize
-import token
 
 __copyright__ = """ The information in this file is
  Copyright(c) 2009 Ball Aerospace & Technologies Corporation
@@ -14,87 +12,71 @@ __copyright__ = """ The information in this file is
  The license text is available from
  http://www.gnu.org/licenses/lgpl.html"""
 
-class StrBufStream:
-    def __init__(self):
-        self.__buf = ""
+# output is buffered natively and sent to Opticks in batches
+sys.stdout = _opticks.OutputStream(0)
+sys.stderr = _opticks.OutputStream(1)
 
-    def available(self):
-        if self.__buf:
-            return len(self.__buf)
-        return 0
+class LazyModule(types.ModuleType):
+    """Stands in for a module in __builtin__ until one of its attributes
+       is used. The module is then imported and replaces the proxy so later
+       lookups go directly to it. References to the proxy which were taken
+       before then continue to forward to the module."""
+    def __init__(self, name):
+        types.ModuleType.__init__(self, name)
 
-    def close(self):
-        self.__buf = None
+    def __module(self):
+        name = types.ModuleType.__getattribute__(self, "__name__")
+        module = __import__(name)
+        if getattr(__builtin__, name, None) is self:
+            setattr(__builtin__, name, module)
+        return module
 
-    def read(self, count):
-        buf = ""
-        if count >= len(self.__buf):
-            buf, self.__buf = self.__buf,""
-        else:
-            buf, self.__buf = self.__buf[:count], self.__buf[count:]
-        return buf
+    def __getattribute__(self, attr):
+        module = types.ModuleType.__getattribute__(self, "_LazyModule__module")
+        return getattr(module(), attr)
 
-    def write(self, buf, count=None):
-        if count is None:
-            count = len(buf)
-        if len(buf) <= count:
-            self.__buf += buf
-            return len(buf)
-        self.__buf += buf[:count]
-        return count
+    def __setattr__(self, attr, value):
+        module = types.ModuleType.__getattribute__(self, "_LazyModule__module")
+        setattr(module(), attr, value)
 
-class CustomStringIO(StringIO.StringIO):
-    def __init__(self, error_stream):
-        StringIO.StringIO.__init__(self)
-        self.is_error_stream = error_stream
+    def __delattr__(self, attr):
+        module = types.ModuleType.__getattribute__(self, "_LazyModule__module")
+        delattr(module(), attr)
 
-    def write(self, s):
-        StringIO.StringIO.write(self, s)
-        self.seek(0)
-        text = self.read()
-        self.truncate(0)
-        _opticks.send_output(text, self.is_error_stream)
-
-sys.stdout = CustomStringIO(0)
-sys.stderr = CustomStringIO(1)
+    def __repr__(self):
+        return "<lazy module '%s'>" % \
+            types.ModuleType.__getattribute__(self, "__name__")
 
 class PythonInteractiveInterpreter(InteractiveInterpreter):
+    """Runs the statements entered in the Scripting Window.
+
+       The PythonEngine splits the input into complete statements so each
+       one is compiled only once."""
     def __init__(self, localAndGlobalDict):
-        self.stdin = None
-        self.buf = ""
         InteractiveInterpreter.__init__(self, localAndGlobalDict)
         sys.ps1 = ""
         sys.ps2 = ""
-        self.more = False
 
-    def push(self, line):
-        if len(self.buf) > 0:
-            self.buf += "\n"
-        self.buf += line
-        more = self.runsource(self.buf)
-        if not more:
-            self.buf = ""
-        return more
+    def run_statement(self, source):
+        """Compile and run a complete statement, echoing expression values."""
+        try:
+            code = compile(source, "<input>", "single")
+        except (OverflowError, SyntaxError, ValueError):
+            self.showsyntaxerror("<input>")
+            return
+        self.runcode(code)
 
-    def process_event(self):
-        """ Process input and return True if input is complete or incorrect;
-            False if input is correct but incomplete
-        """
-        if not self.stdin:
-            return True # invalid stdin
-        line = self.stdin.read(self.stdin.available())
-        lines = line.split("\n")
-        for the_line in lines:
-            self.more = self.push(the_line)
-        if self.more and line.count("\n") >= 1:
-            tempStr = StringIO.StringIO(line)
-            space_count = 0
-            token_iter = tokenize.generate_tokens(tempStr.readline)
-            val = token_iter.next()
-            if (val[0] == tokenize.INDENT):
-                space_count = val[3][1]
-            #add two lines with space equal to the indent level and re-run command
-            #the reason for two lines is to terminate a line continuation and
-            #a block
-            self.more = self.push(" " * space_count + "\n" + " " * space_count)
-        return not(self.more)
+def prepare_script(globs, filename, inputs, outputs, results):
+    """Add the variables seen by a script run by the Run Python Script
+       plug-in. The argument lists and results are passed as addresses
+       or None."""
+    import opticks
+    globs["__name__"] = "__main__"
+    globs["__file__"] = filename
+    globs["inputs"] = globs["outputs"] = globs["results"] = None
+    if inputs is not None:
+        globs["inputs"] = opticks.PlugInArgList(inputs)
+    if outputs is not None:
+        globs["outputs"] = opticks.PlugInArgList(outputs)
+    if results is not None:
+        globs["results"] = opticks.DynamicObject(wrapper=results)
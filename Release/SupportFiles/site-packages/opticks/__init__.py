@@ -10,6 +10,9 @@ and similar functions although help(object) will work.
 import _opticks
 import sys
 import ctypes
+import threading
+import Queue
+import collections
 
 __copyright__ = """The information in this file is
  Copyright(c) 2009 Ball Aerospace & Technologies Corporation
@@ -44,16 +47,10 @@ class SimpleApiError(OpticksError):
         self.code = code
         self.result = result
 
-def _simple_error_check(result, func, args):
-    """This errcheck function queries the last error state
-    and raises an exception if an error occured
-
-    """
-    #pylint: disable=W0212,W0613
-    err = SimpleApiError._get_last_error()
-    if err != SimpleApiError.SIMPLE_NO_ERROR:
-        raise SimpleApiError(err, result)
-    return args
+# This errcheck function queries the last error state and raises a
+# SimpleApiError if an error occured. It is native so the check does not
+# need a second ctypes call.
+_simple_error_check = _opticks.error_check
 
 
 try:
@@ -63,6 +60,9 @@ try:
         __API = ctypes.CDLL("SimpleApiLib")
     pyobj = ctypes.py_object(_opticks.handle())
     __API.setHandle(ctypes.pythonapi.PyCObject_AsVoidPtr(pyobj))
+    _opticks.set_error_source(
+        ctypes.cast(__API.getLastError, ctypes.c_void_p).value, SimpleApiError)
+    __BINDINGS = {}
     def _genwrap(name, *args, **kargs):
         """Create a wrapper function for an API function.
         First arg is the name of the C function.
@@ -73,12 +73,20 @@ try:
         a SimpleApiError exception. The default is to include
         error checking.
 
+        Each wrapper is created once and shared by later requests for
+        the same function and signature so the prototype and symbol
+        lookup are not repeated.
+
         """
-        prototype = apply(ctypes.CFUNCTYPE, args)
-        func = prototype((name, __API))
         error_check = kargs.get('errorCheck', True)
-        if error_check:
-            func.errcheck = _simple_error_check
+        key = (name, args, error_check)
+        func = __BINDINGS.get(key)
+        if func is None:
+            prototype = apply(ctypes.CFUNCTYPE, args)
+            func = prototype((name, __API))
+            if error_check:
+                func.errcheck = _simple_error_check
+            __BINDINGS[key] = func
         return func
 except EnvironmentError:
     print "ERROR: The SimpleApiLib dynamic library could not be located. "\
@@ -100,6 +108,18 @@ def version_info():
     pver = _opticks.pythonVersion()
     return over, pver
 
+def progress(message, percent=0):
+    """Report the progress of the running script to Opticks.
+    percent is an integer from 0 to 100. Returns False if the script
+    was not run with a progress object, for instance when it is typed
+    into the Scripting Window.
+
+    If the user aborts the script, KeyboardInterrupt is raised in the
+    script shortly afterwards.
+
+    """
+    return _opticks.progress(message, int(percent))
+
 def _stringbuffer_wrap(func, *args, **kargs):
     """This function calls a
     'ctypes.c_uint32 func(ctypes.c_char_p, ctypes.c_uin32)' function and
@@ -122,6 +142,19 @@ def _stringbuffer_wrap(func, *args, **kargs):
         apply(func, tmpargs)
     return ctypes.string_at(buf)
 
+def _cached_property(obj, kind, key, compute):
+    """Get a property of a DataElement or Layer from the per handle cache,
+    calling compute() if it isn't cached. The cache is emptied when the
+    object is modified or deleted."""
+    if not obj.handle:
+        return compute()
+    cache = _opticks.property_cache(obj.handle, kind)
+    try:
+        return cache[key]
+    except KeyError:
+        value = cache[key] = compute()
+        return value
+
 SimpleApiError._get_last_error = \
     _genwrap("getLastError", ctypes.c_int, errorCheck=False)
 SimpleApiError._set_last_error = \
@@ -129,37 +162,28 @@ SimpleApiError._set_last_error = \
 SimpleApiError._getErrorString = \
     _genwrap("getErrorString", ctypes.c_char_p, ctypes.c_int, errorCheck=False)
 
-def _void_p_to_native(typename, value):
+def _void_p_to_native(typename, value, owner=None):
+    """Convert the value of an Opticks type at an address. Numbers are
+    converted natively and vectors of them are returned as writable
+    _opticks.VariantArray views which keep owner alive. Other types are
+    returned as a ctypes.c_void_p."""
     #pylint: disable=W0212
+    if isinstance(value, ctypes.c_void_p):
+        value = value.value
+    native = _opticks.native_value(typename, value, owner)
+    if native is not None:
+        return native
+
+    # 64 bit integers are stored in wrapper classes
     typ = None
     isvector = False
     if typename.startswith("vector<"):
         typename = typename[7:-1]
         isvector = True
-    if typename == "char":
-        typ = ctypes.c_byte
-    elif typename == "unsigned char":
-        typ = ctypes.c_ubyte
-    elif typename == "short":
-        typ = ctypes.c_short
-    elif typename == "unsigned short":
-        typ = ctypes.c_ushort
-    elif typename == "int":
-        typ = ctypes.c_int
-    elif typename == "unsigned int":
-        typ = ctypes.c_uint
-    elif typename == "long":
-        typ = ctypes.c_long
-    elif typename == "unsigned long":
-        typ = ctypes.c_ulong
-    elif typename == "Int64" or typename == "int64":
+    if typename == "Int64" or typename == "int64":
         typ = ctypes.c_longlong
     elif typename == "UInt64" or typename == "uint64":
         typ = ctypes.c_ulonglong
-    elif typename == "float":
-        typ = ctypes.c_float
-    elif typename == "double":
-        typ = ctypes.c_double
     else:
         return ctypes.cast(value, ctypes.c_void_p)
     if isvector:
@@ -171,6 +195,47 @@ def _void_p_to_native(typename, value):
         return ctypes.cast(rval, ctypes.POINTER(typ)).contents
     return ctypes.cast(value, ctypes.POINTER(typ)).contents.value
 
+def _native_variant_handle(value, typ):
+    """Create a DataVariant of a numeric type or a vector of one from a
+    number, a sequence or a numpy array without an XML round trip. Returns
+    the address of the new DataVariant or None if the value can't be
+    stored natively."""
+    fmt = _opticks.native_format(typ)
+    if fmt is None or isinstance(value, basestring):
+        return None
+    values = None
+    if hasattr(value, "__array_interface__") or hasattr(value, "__array__"):
+        try:
+            import numpy
+            values = numpy.ascontiguousarray(value, dtype=fmt).ravel()
+        except ImportError:
+            pass
+    if values is None:
+        import array
+        if typ.startswith("vector<"):
+            values = array.array(fmt, value)
+        else:
+            values = array.array(fmt, [value])
+    return _opticks.variant_from_array(typ, values)
+
+def _adopt_variant(handle):
+    """Wrap a DataVariant created by _opticks and take ownership of it."""
+    #pylint: disable=W0212
+    variant = DataVariant.__new__(DataVariant)
+    ctypes.Structure.__init__(variant)
+    variant.handle = handle
+    variant._DataVariant__owns = True
+    return variant
+
+def _variant_for_update(value):
+    """Convert a value DynamicObject.update can't store natively."""
+    if isinstance(value, DataVariant):
+        return value
+    if isinstance(value, DynamicObject):
+        return DataVariant(ctypes.cast(value.handle, ctypes.c_void_p),
+                           "DynamicObject")
+    return DataVariant(value)
+
 def _prep_for_set(value, typ):
     #pylint: disable=W0212
     retval = None
@@ -180,44 +245,13 @@ def _prep_for_set(value, typ):
         rval = value.cast_data_element(typ)
         if rval != 0:
             retval = ctypes.c_void_p(rval)
-    elif typ == "char":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_byte(value)),
-                             ctypes.c_void_p)
-    elif typ == "short":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_short(value)),
-                             ctypes.c_void_p)
-    elif typ == "int":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_int(value)),
-                             ctypes.c_void_p)
-    elif typ == "long":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_long(value)),
-                             ctypes.c_void_p)
-    elif typ == "Int64":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_longlong(value)),
-                             ctypes.c_void_p)
-    elif typ == "unsigned char":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_ubyte(value)),
-                             ctypes.c_void_p)
-    elif typ == "unsigned short":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_ushort(value)),
-                             ctypes.c_void_p)
-    elif typ == "unsigned int":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_uint(value)),
-                             ctypes.c_void_p)
-    elif typ == "unsigned long":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_ulong(value)),
-                             ctypes.c_void_p)
-    elif typ == "UInt64":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_ulonglong(value)),
-                             ctypes.c_void_p)
-    elif typ == "float":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_float(value)),
-                             ctypes.c_void_p)
-    elif typ == "double":
-        retval = ctypes.cast(ctypes.pointer(ctypes.c_double(value)),
-                             ctypes.c_void_p)
-    else: # try an XML string conversion
-        retval = DataVariant._createDataVariantFromString(typ, str(value), 1)
+    else:
+        handle = _native_variant_handle(value, typ)
+        if handle is not None:
+            retval = _adopt_variant(handle)
+        else: # try an XML string conversion
+            retval = DataVariant._createDataVariantFromString(typ, str(value),
+                                                              1)
     return retval
 
 class DataElement(ctypes.Structure, object):
@@ -240,12 +274,11 @@ class DataElement(ctypes.Structure, object):
     @classmethod
     def all(cls, typ=None):
         """Get all top-level data elements of a specific type. If no type is specified, get all top-level data elements."""
-        tempf = _genwrap("getDataElements", ctypes.c_int, ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(DataElement))
         if typ is None:
             typ = ctypes.c_char_p(0)
-        cnt = tempf(typ, 0, None)
+        cnt = cls._getDataElements(typ, 0, None)
         elements = (DataElement * cnt)()
-        tempf(typ, cnt, elements)
+        cls._getDataElements(typ, cnt, elements)
         return [i.leafclass() for i in elements]
 
     @classmethod
@@ -258,9 +291,7 @@ class DataElement(ctypes.Structure, object):
 
     def __del__(self):
         if self.__owns:
-            tempf = _genwrap("destroyDataElement", None, DataElement,
-                             errorCheck=False)
-            tempf(self)
+            self._destroyDataElement(self)
 
     def destroy(self, val=True):
         self.__owns = val
@@ -282,11 +313,13 @@ class DataElement(ctypes.Structure, object):
 
     @property
     def name(self):
-        return _stringbuffer_wrap(self._getDataElementName, self)
+        return _cached_property(self, "DataElement", "name",
+            lambda: _stringbuffer_wrap(self._getDataElementName, self))
 
     @property
     def type(self):
-        return _stringbuffer_wrap(self._getDataElementType, self)
+        return _cached_property(self, "DataElement", "type",
+            lambda: _stringbuffer_wrap(self._getDataElementType, self))
 
     @property
     def filename(self):
@@ -334,6 +367,11 @@ DataElement._getDataElementType = \
 DataElement._getDataElementFilename = \
     _genwrap("getDataElementFilename", ctypes.c_uint32, DataElement,
              ctypes.c_char_p, ctypes.c_uint32)
+DataElement._getDataElements = \
+    _genwrap("getDataElements", ctypes.c_int, ctypes.c_char_p, ctypes.c_int,
+             ctypes.POINTER(DataElement))
+DataElement._destroyDataElement = \
+    _genwrap("destroyDataElement", None, DataElement, errorCheck=False)
 DataElement._getDataElementChildCount = \
     _genwrap("getDataElementChildCount", ctypes.c_uint32, DataElement)
 DataElement._getDataElementChild = \
@@ -353,6 +391,10 @@ class DataVariant(ctypes.Structure):
         self.__owns = True
         import types
         if vtype is not None and not isinstance(value, ctypes.c_void_p):
+            handle = _native_variant_handle(value, str(vtype))
+            if handle is not None:
+                self.handle = handle
+                return
             self.handle = \
                 DataVariant._createDataVariantFromString(str(vtype),
                                                          str(value),
@@ -401,6 +443,17 @@ class DataVariant(ctypes.Structure):
                         value = ctypes.pointer(ctypes.c_ulonglong(value))
             elif type(value) == types.FloatType:
                 vtype, value = "float", ctypes.pointer(ctypes.c_float(value))
+            elif hasattr(value, "dtype") or hasattr(value, "typecode"):
+                # numpy and array module arrays become vectors
+                fmt = getattr(value, "typecode", None) or value.dtype.char
+                vtype = _opticks.native_type_name(fmt)
+                if vtype is None:
+                    raise OpticksError("Can't automatically convert %s "
+                                       "arrays." % fmt)
+                if getattr(value, "ndim", 1) != 0:
+                    vtype = "vector<%s>" % vtype
+                self.handle = _native_variant_handle(value, vtype)
+                return
             else:
                 raise OpticksError("Can't automatically convert %s." %
                                    str(type(value)))
@@ -443,7 +496,8 @@ class DataVariant(ctypes.Structure):
     def value(self):
         if self.dv_type == "string": # special case..can't handle std::string
             return self.xml
-        return _void_p_to_native(self.dv_type, self._getDataVariantValue(self))
+        return _void_p_to_native(self.dv_type, self._getDataVariantValue(self),
+                                 self)
 
 class PlugInArgList(ctypes.Structure):
     _fields_ = [("handle", ctypes.c_void_p)]
@@ -503,13 +557,13 @@ class PlugInArg(ctypes.Structure):
 
     @property
     def value(self):
-        return _void_p_to_native(self.type, self._getPlugInArgValue(self))
+        return _void_p_to_native(self.type, self._getPlugInArgValue(self), self)
 
     def get_default(self):
         if not self.default_set:
             raise OpticksError("Default value is not set.")
         return _void_p_to_native(self.type,
-                                 self._getPlugInArgDefaultValue(self))
+                                 self._getPlugInArgDefaultValue(self), self)
 
     def set_default(self, value):
         value = _prep_for_set(value, self.type)
@@ -526,7 +580,8 @@ class PlugInArg(ctypes.Structure):
     def get_actual(self):
         if not self.actual_set:
             raise OpticksError("Actual value is not set.")
-        return _void_p_to_native(self.type, self._getPlugInArgActualValue(self))
+        return _void_p_to_native(self.type,
+                                 self._getPlugInArgActualValue(self), self)
 
     def set_actual(self, value):
         value = _prep_for_set(value, self.type)
@@ -552,7 +607,8 @@ class WizardNode(ctypes.Structure):
         return _stringbuffer_wrap(self._getWizardNodeType, self)
 
     def get_value(self):
-        value = _void_p_to_native(self.type, self._getWizardNodeValue(self))
+        value = _void_p_to_native(self.type, self._getWizardNodeValue(self),
+                                  self)
         if isinstance(value, ctypes.c_void_p):
             new_dv = DataVariant(value, self.type)
             if new_dv.valid:
@@ -855,6 +911,18 @@ class DynamicObject(ctypes.Structure):
                                          meta, idx)
         return do_iter(self, len(self))
 
+    def to_dict(self):
+        """Copy all attributes into a dict in one call. Child DynamicObjects
+        become dicts, numbers and strings and vectors of them become Python
+        values and anything else is returned as a DataVariant."""
+        return _opticks.dynamic_object_to_dict(self.handle, _adopt_variant)
+
+    def update(self, values):
+        """Set attributes from a dict in one call. Nested dicts are merged
+        into child DynamicObjects, creating them as needed."""
+        _opticks.dynamic_object_update(self.handle, dict(values),
+                                       _variant_for_update)
+
     def __str__(self):
         return "<DynamicObject with %i attribute(s)>" % len(self)
 
@@ -1257,30 +1325,18 @@ class AoiIterator(ctypes.Structure):
         try:
             if raster is not None:
                 if element is None:
-                    tempf = _genwrap("createAoiIteratorOverRaster",
-                                     AoiIterator, ctypes.c_void_p, DataElement)
-                    self.handle = tempf(element, raster).handle
+                    tempf = self._createAoiIteratorOverRaster
                 else:
-                    tempf = _genwrap("createAoiIteratorOverRaster",
-                                     AoiIterator, DataElement, DataElement)
-                    self.handle = tempf(element, raster).handle
+                    tempf = self._createAoiIteratorOverRasterWithAoi
+                self.handle = tempf(element, raster).handle
             else:
                 if element is None:
-                    tempf = _genwrap("createAoiIteratorOverBoundingBox",
-                                     AoiIterator, ctypes.c_void_p,
-                                     ctypes.c_int32, ctypes.c_int32,
-                                     ctypes.c_int32, ctypes.c_int32)
-                    self.handle = tempf(element, bounding_box[0],
-                                        bounding_box[1], bounding_box[2],
-                                        bounding_box[3]).handle
+                    tempf = self._createAoiIteratorOverBoundingBox
                 else:
-                    tempf = _genwrap("createAoiIteratorOverBoundingBox",
-                                     AoiIterator, DataElement,
-                                     ctypes.c_int32, ctypes.c_int32,
-                                     ctypes.c_int32, ctypes.c_int32)
-                    self.handle = tempf(element, bounding_box[0],
-                                        bounding_box[1], bounding_box[2],
-                                        bounding_box[3]).handle
+                    tempf = self._createAoiIteratorOverBoundingBoxWithAoi
+                self.handle = tempf(element, bounding_box[0],
+                                    bounding_box[1], bounding_box[2],
+                                    bounding_box[3]).handle
             self.__last = False
         except SimpleApiError, err:
             if err.code == SimpleApiError.SIMPLE_NOT_FOUND:
@@ -1289,7 +1345,7 @@ class AoiIterator(ctypes.Structure):
 
     def __del__(self):
         if self.__owns:
-            _genwrap("freeAoiIterator", None, AoiIterator)(self)
+            self._freeAoiIterator(self)
 
     def __iter__(self):
         return self
@@ -1306,6 +1362,20 @@ class AoiIterator(ctypes.Structure):
                                      ctypes.byref(column),
                                      ctypes.byref(row))
         return column.value, row.value
+AoiIterator._createAoiIteratorOverRaster = \
+    _genwrap("createAoiIteratorOverRaster", AoiIterator, ctypes.c_void_p,
+             DataElement)
+AoiIterator._createAoiIteratorOverRasterWithAoi = \
+    _genwrap("createAoiIteratorOverRaster", AoiIterator, DataElement,
+             DataElement)
+AoiIterator._createAoiIteratorOverBoundingBox = \
+    _genwrap("createAoiIteratorOverBoundingBox", AoiIterator, ctypes.c_void_p,
+             ctypes.c_int32, ctypes.c_int32, ctypes.c_int32, ctypes.c_int32)
+AoiIterator._createAoiIteratorOverBoundingBoxWithAoi = \
+    _genwrap("createAoiIteratorOverBoundingBox", AoiIterator, DataElement,
+             ctypes.c_int32, ctypes.c_int32, ctypes.c_int32, ctypes.c_int32)
+AoiIterator._freeAoiIterator = \
+    _genwrap("freeAoiIterator", None, AoiIterator)
 AoiIterator._nextAoiIterator = \
     _genwrap("nextAoiIterator", ctypes.c_int, AoiIterator)
 AoiIterator._getAoiIteratorLocation = \
@@ -1398,6 +1468,93 @@ class Aoi(DataElement):
         bbox = (min_column, min_row, max_column, max_row)
         return AoiIterator(self, bounding_box = bbox)
 
+    def to_mask(self, bbox=None, packed=False):
+        """Get the selection state of a region of the AOI as a numpy
+        array indexed by [row, column]. bbox is an inclusive
+        (min_column, min_row, max_column, max_row) tuple and defaults
+        to the minimal bounding box. If packed is False, the result is
+        a boolean array. Otherwise each row is packed into a uint8
+        array as numpy.packbits() would.
+
+        """
+        #pylint: disable=W0621
+        try:
+            import numpy
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        if bbox is None:
+            bbox = self.minimal_bounding_box
+        min_column, min_row, max_column, max_row = bbox
+        data = _opticks.aoi_to_mask(self.handle, min_column, min_row,
+                                    max_column, max_row, int(packed))
+        rows = max_row - min_row + 1
+        if packed:
+            mask = numpy.fromstring(data, dtype=numpy.uint8)
+        else:
+            mask = numpy.fromstring(data, dtype=numpy.bool_)
+        mask.shape = (rows, len(data) // rows)
+        return mask
+
+    def set_mask(self, mask, origin=(0, 0), columns=None, packed=False):
+        """Set the selection state of a region of the AOI from a numpy
+        array indexed by [row, column]. origin is the (column, row)
+        of mask[0, 0]. Pixels which are True in the mask are selected
+        and pixels which are False are deselected. If packed is True,
+        the mask is treated as the output of numpy.packbits() along
+        each row, as returned by to_mask(packed=True), and columns is
+        the unpacked width, which defaults to 8 * mask.shape[1].
+
+        """
+        #pylint: disable=W0621
+        try:
+            import numpy
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        mask = numpy.asarray(mask)
+        if len(mask.shape) != 2:
+            raise ValueError("Mask must be 2-d")
+        if packed:
+            mask = mask.astype(numpy.uint8)
+            if columns is None:
+                columns = mask.shape[1] * 8
+        else:
+            columns = mask.shape[1]
+            mask = mask.astype(numpy.bool_)
+        _opticks.aoi_set_mask(self.handle, origin[0], origin[1],
+                              mask.shape[0], columns,
+                              numpy.ascontiguousarray(mask), int(packed))
+
+    REDUCE_STATS = ("mean", "std", "min", "max", "count", "hist")
+
+    def reduce(self, raster, stats=REDUCE_STATS, bands=None, bins=256):
+        """Calculate statistics for each band of a RasterElement over the
+        pixels selected by the AOI. stats names the statistics to
+        calculate and bands is a sequence of band indices which defaults
+        to every band. A dict is returned which maps each statistic to a
+        list with one value per band. The std is the population standard
+        deviation. Each "hist" value is a (counts, lower, upper) tuple
+        with bins equal width bins over the band's range. NaN values are
+        ignored and the statistics of a band with no values are NaN.
+
+        The reduction is done natively by reading the AOI's bounding box
+        a chunk at a time on multiple threads.
+
+        """
+        unknown = [stat for stat in stats if stat not in self.REDUCE_STATS]
+        if unknown:
+            raise ValueError("Unknown statistics %s" % ", ".join(unknown))
+        if bands is None:
+            bands = range(_opticks.raster_info(raster.handle)[2])
+        if "hist" not in stats:
+            bins = 0
+        elif bins < 1:
+            raise ValueError("bins must be at least 1")
+        results = _opticks.aoi_reduce(self.handle, raster.handle,
+                                      list(bands), bins)
+        columns = dict(zip(("count", "mean", "std", "min", "max", "hist"),
+                           zip(*results) or [()] * 6))
+        return dict((stat, list(columns[stat])) for stat in stats)
+
 class DataAccessor(ctypes.Structure):
     """Wrapper for an Opticks data accessor. This is the most
     flexible data access method but is also the most complex.
@@ -1407,9 +1564,7 @@ class DataAccessor(ctypes.Structure):
 
     def __del__(self):
         if self.__owns:
-            tempf = _genwrap("destroyDataAccessor", None, DataAccessor,
-                             errorCheck=False)
-            tempf(self)
+            self._destroyDataAccessor(self)
 
     def initialize(self, *args):
         #pylint: disable=W0201
@@ -1487,6 +1642,8 @@ class DataAccessor(ctypes.Structure):
     def row_size(self):
         return self._rowsize(self)
 
+DataAccessor._destroyDataAccessor = \
+    _genwrap("destroyDataAccessor", None, DataAccessor, errorCheck=False)
 DataAccessor._getDataAccessorRow = \
     _genwrap("getDataAccessorRow", ctypes.c_void_p, DataAccessor)
 DataAccessor._getDataAccessorColumn = \
@@ -1511,65 +1668,41 @@ def _create_raster_block():
     try:
         import numpy
         class RasterBlock(numpy.ndarray):
+            """A numpy.ndarray on raster element data.
+            The array is backed by an _opticks.RasterBuffer which is either
+            a view on the raster element's memory or a copy owned by the
+            buffer. The buffer is released when the last array using it
+            is deleted. A view is invalidated when the raster element is
+            destroyed and its data must not be used after valid is False.
+
+            """
             #pylint: disable=E1101, W0201, W0212, W0232
             def __new__(cls, raster, args):
-                own = ctypes.c_int(0)
-                ptr = raster._createDataPointer(raster, args, ctypes.byref(own))
-                rows = args.row_end - args.row_start + 1
-                cols = args.column_end - args.column_start + 1
-                bands = args.band_end - args.band_start + 1
-                nfo = DataInfo(raster)
-                func = ctypes.pythonapi.PyBuffer_FromMemory
-                func.restype = ctypes.py_object
-                datalen = rows * cols * bands * nfo.encoding_size
-                dbuffer = func(ptr, datalen)
-                if nfo.interleave.value == Interleave.BIP:
-                    shape = (rows, cols, bands)
-                elif nfo.interleave.value == Interleave.BSQ:
-                    shape = (bands, rows, cols)
-                elif nfo.interleave.value == Interleave.BIL:
-                    shape = (rows, bands, cols)
-                ntype = nfo.encoding.to_numpy_type()
-                self = numpy.ndarray.__new__(cls, shape,
-                                             dtype=ntype,
-                                             buffer=dbuffer,
-                                             offset=0, order='C')
-                self._rasterhandle = dbuffer
-                self._rasterptr = ptr
-                self._ownraster = own
-                self.interleave = nfo.interleave
+                dbuffer = _opticks.raster_buffer(raster.handle,
+                                                 args.row_start, args.row_end,
+                                                 args.column_start,
+                                                 args.column_end,
+                                                 args.band_start, args.band_end,
+                                                 args.interleave.value)
+                return cls._from_buffer(dbuffer)
+            @classmethod
+            def _from_buffer(cls, dbuffer):
+                self = numpy.asarray(dbuffer).view(cls)
+                self.interleave = Interleave(dbuffer.interleave)
                 return self
             def __array_finalize__(self, obj):
-                if hasattr(obj, '_rasterhandle'):
-                    self._rasterhandle = obj._rasterhandle
-                    self._rasterptr = obj._rasterptr
-                    self._ownraster = obj._ownraster
-                    self.interleave = obj.interleave
-                else:
-                    self._rasterhandle = None
-                    self._rasterptr = None
-                    self._ownraster = False
-                    self.interleave = None
-            def _close(self):
-                """Release shared memory.  Only do this 
-                when deleting the object.
+                self.interleave = getattr(obj, 'interleave', None)
+            @property
+            def valid(self):
+                """False once the raster element under a view has been
+                destroyed. Blocks which own their data are always valid.
 
                 """
-                if self.base is self._rasterhandle and self._ownraster:
-                    tempf = _genwrap("destroyDataPointer", None,
-                                     ctypes.c_void_p, errorCheck=False)
-                    tempf(self._rasterptr)
-                    self._rasterhandle = None
-                    self._rasterptr = None
-                    self._ownraster = False
-                    self.interleave = None
-            def __del__(self):
-                # We first check if we are the owner of
-                # the _rasterptr, rather than
-                # a view, so deleting a view does not call _close
-                # on the parent _rasterptr
-                if self._rasterhandle is self.base:
-                    self._close()
+                base = self.base
+                while base is not None and \
+                        not isinstance(base, _opticks.RasterBuffer):
+                    base = getattr(base, "base", None)
+                return base is None or base.valid
         _RASTER_BLOCK_TYPE = RasterBlock
     except ImportError:
         pass
@@ -1589,6 +1722,29 @@ class _DataArrayTemp(object):
         self.raster = raster
         self.fixed = fixed
 
+    def _ranges(self, key, info):
+        """Convert an index into inclusive (start, end, step) tuples
+        for rows, columns and bands. A step selects every n-th
+        element from start up to and including end.
+
+        """
+        rows, columns, bands, interleave = info[:4]
+        if self.fixed:
+            idx = self.parse_indices(key, (bands - 1, columns - 1, rows - 1))
+            ranges = (idx[2], idx[1], idx[0])
+        elif interleave == Interleave.BIP:
+            idx = self.parse_indices(key, (rows - 1, columns - 1, bands - 1))
+            ranges = (idx[0], idx[1], idx[2])
+        elif interleave == Interleave.BSQ:
+            idx = self.parse_indices(key, (bands - 1, rows - 1, columns - 1))
+            ranges = (idx[1], idx[2], idx[0])
+        elif interleave == Interleave.BIL:
+            idx = self.parse_indices(key, (rows - 1, bands - 1, columns - 1))
+            ranges = (idx[0], idx[2], idx[1])
+        if idx[0][2] < 1 or idx[1][2] < 1 or idx[2][2] < 1:
+            raise IndexError("Negative step factors not supported")
+        return ranges
+
     def __getitem__(self, key):
         try:
             #pylint: disable=W0612, W0621
@@ -1597,110 +1753,78 @@ class _DataArrayTemp(object):
                 _create_raster_block()
         except ImportError:
             raise NotImplementedError("numpy is not available")
-        args = None
-        nfo  = DataInfo(self.raster)
-        if self.fixed:
-            idx = self.parse_indices(key,
-                                     (nfo.bands - 1,
-                                      nfo.columns - 1,
-                                      nfo.rows - 1))
-            args = DataPointerArgs(idx[2][0], idx[2][1],
-                                  idx[1][0], idx[1][1],
-                                  idx[0][0], idx[0][1],
-                                  nfo.interleave)
-        elif nfo.interleave.value == Interleave.BIP:
-            idx = self.parse_indices(key,
-                                     (nfo.rows - 1,
-                                      nfo.columns - 1,
-                                      nfo.bands - 1))
-            args = DataPointerArgs(idx[0][0], idx[0][1],
-                                  idx[1][0], idx[1][1],
-                                  idx[2][0], idx[2][1],
-                                  nfo.interleave)
-        elif nfo.interleave.value == Interleave.BSQ:
-            idx = self.parse_indices(key,
-                                     (nfo.bands - 1,
-                                      nfo.rows - 1,
-                                      nfo.columns - 1))
-            args = DataPointerArgs(idx[1][0], idx[1][1],
-                                  idx[2][0], idx[2][1],
-                                  idx[0][0], idx[0][1],
-                                  nfo.interleave)
-        elif nfo.interleave.value == Interleave.BIL:
-            idx = self.parse_indices(key,
-                                     (nfo.rows - 1,
-                                      nfo.bands - 1,
-                                      nfo.columns - 1))
-            args = DataPointerArgs(idx[0][0], idx[0][1],
-                                  idx[2][0], idx[2][1],
-                                  idx[1][0], idx[1][1],
-                                  nfo.interleave)
-        if idx[0][2] != 1 or idx[1][2] != 1 or idx[2][2] != 1:
-            raise IndexError("Step factors other than 1 not supported")
-        return _RASTER_BLOCK_TYPE(self.raster, args)
+        info = _opticks.raster_info(self.raster.handle)
+        rows, columns, bands = self._ranges(key, info)
+        dbuffer = _opticks.raster_buffer(self.raster.handle,
+                                         rows[0], rows[1],
+                                         columns[0], columns[1],
+                                         bands[0], bands[1],
+                                         info[3],
+                                         rows[2], columns[2], bands[2])
+        return _RASTER_BLOCK_TYPE._from_buffer(dbuffer)
 
     def __setitem__(self, key, data):
+        self.write(key, data)
+
+    def write(self, key, data, scale=None, offset=None):
+        """Write a numpy array to the region selected by key, as
+        data_array[key] = data does. If the array's dtype differs from
+        the raster's encoding or a scale or offset is specified, each
+        value is converted natively as it is written: value * scale +
+        offset is rounded to the nearest integer for integer encodings and
+        clamped to the range of the encoding. No converted copy of the
+        array is made.
+
+        """
         #pylint: disable=W0212, W0612, W0621
         try:
             import numpy
         except ImportError:
             # numpy wrapper will not be available
             raise NotImplementedError("numpy is not available")
-        nfo  = DataInfo(self.raster)
+        info = _opticks.raster_info(self.raster.handle)
         if not isinstance(data, numpy.ndarray):
             raise TypeError("Invalid data type, must be "\
                             "numpy.ndarray or ctypes.c_void_p")
-        if nfo.encoding.to_numpy_type() != str(data.dtype):
-            raise ValueError("Array has wrong dtype.")
 
-        args = None
-        if self.fixed:
-            idx = self.parse_indices(key,
-                                     (nfo.bands - 1,
-                                      nfo.columns - 1,
-                                      nfo.rows - 1))
-            args = DataPointerArgs(idx[2][0], idx[2][1],
-                                  idx[1][0], idx[1][1],
-                                  idx[0][0], idx[0][1],
-                                  nfo.interleave)
-        elif nfo.interleave.value == Interleave.BIP:
-            idx = self.parse_indices(key,
-                                     (nfo.rows - 1,
-                                      nfo.columns - 1,
-                                      nfo.bands - 1))
-            args = DataPointerArgs(idx[0][0], idx[0][1],
-                                  idx[1][0], idx[1][1],
-                                  idx[2][0], idx[2][1],
-                                  nfo.interleave)
-        elif nfo.interleave.value == Interleave.BSQ:
-            idx = self.parse_indices(key,
-                                     (nfo.bands - 1,
-                                      nfo.rows - 1,
-                                      nfo.columns - 1))
-            args = DataPointerArgs(idx[1][0], idx[1][1],
-                                  idx[2][0], idx[2][1],
-                                  idx[0][0], idx[0][1],
-                                  nfo.interleave)
-        elif nfo.interleave.value == Interleave.BIL:
-            idx = self.parse_indices(key,
-                                     (nfo.rows - 1,
-                                      nfo.bands - 1,
-                                      nfo.columns - 1))
-            args = DataPointerArgs(idx[0][0], idx[0][1],
-                                  idx[2][0], idx[2][1],
-                                  idx[1][0], idx[1][1],
-                                  nfo.interleave)
-        if idx[0][2] != 1 or idx[1][2] != 1 or idx[2][2] != 1:
-            raise IndexError("Step factors other than 1 not supported")
-        required_size = ((args.row_end - args.row_start + 1) *
-                         (args.column_end - args.column_start + 1) *
-                         (args.band_end - args.band_start + 1))
+        rows, columns, bands = self._ranges(key, info)
+        required_size = (((rows[1] - rows[0]) // rows[2] + 1) *
+                         ((columns[1] - columns[0]) // columns[2] + 1) *
+                         ((bands[1] - bands[0]) // bands[2] + 1))
         if required_size != data.size:
             raise ValueError("Array has %s items, but must " \
                              "have %s items" % (data.size, required_size))
 
-        rawdata = data.ctypes.data_as(ctypes.c_void_p)
-        RasterElement._copyDataToRasterElement(self.raster, args, rawdata)
+        if (scale is not None or offset is not None or
+                Encoding(info[4]).to_numpy_type() != str(data.dtype)):
+            data = numpy.ascontiguousarray(data)
+            if not data.dtype.isnative:
+                data = data.astype(data.dtype.newbyteorder("="))
+            _opticks.raster_write(self.raster.handle,
+                                  rows[0], rows[1],
+                                  columns[0], columns[1],
+                                  bands[0], bands[1],
+                                  info[3], data,
+                                  rows[2], columns[2], bands[2],
+                                  data.dtype.char,
+                                  1.0 if scale is None else scale,
+                                  0.0 if offset is None else offset)
+        elif rows[2] == 1 and columns[2] == 1 and bands[2] == 1:
+            args = DataPointerArgs(rows[0], rows[1],
+                                   columns[0], columns[1],
+                                   bands[0], bands[1],
+                                   info[3])
+            data = numpy.ascontiguousarray(data)
+            rawdata = data.ctypes.data_as(ctypes.c_void_p)
+            RasterElement._copyDataToRasterElement(self.raster, args, rawdata)
+        else:
+            # only the selected rows, columns and bands are written
+            _opticks.raster_write(self.raster.handle,
+                                  rows[0], rows[1],
+                                  columns[0], columns[1],
+                                  bands[0], bands[1],
+                                  info[3], numpy.ascontiguousarray(data),
+                                  rows[2], columns[2], bands[2])
 
     @staticmethod
     def parse_indices(key, dims):
@@ -1743,12 +1867,184 @@ class _DataArrayTemp(object):
 
         return key_t
 
+class _TileTask(object):
+    "A call queued on a _TilePool."
+    def __init__(self, func, args):
+        self.__func, self.__args = func, args
+        self.__done = threading.Event()
+        self.__result = self.__error = None
+
+    def run(self):
+        #pylint: disable=W0702
+        try:
+            self.__result = self.__func(*self.__args)
+        except:
+            self.__error = sys.exc_info()
+        self.__done.set()
+
+    def result(self):
+        """Wait for the call and return its result or raise its
+        exception."""
+        self.__done.wait()
+        if self.__error is not None:
+            raise self.__error[0], self.__error[1], self.__error[2]
+        return self.__result
+
+class _TilePool(object):
+    """A fixed set of threads used by RasterElement.map_tiles. With fewer
+    than two workers, calls are made on the calling thread."""
+    def __init__(self, workers):
+        self.__tasks = Queue.Queue()
+        self.__threads = []
+        if workers > 1:
+            for idx in range(workers):
+                thread = threading.Thread(target=self.__run,
+                                          name="map_tiles %i" % idx)
+                thread.setDaemon(True)
+                thread.start()
+                self.__threads.append(thread)
+
+    def __run(self):
+        while True:
+            task = self.__tasks.get()
+            if task is None:
+                return
+            task.run()
+
+    def submit(self, func, *args):
+        task = _TileTask(func, args)
+        if self.__threads:
+            self.__tasks.put(task)
+        else:
+            task.run()
+        return task
+
+    def close(self):
+        """Wait for the queued calls and stop the threads."""
+        for thread in self.__threads:
+            self.__tasks.put(None)
+        for thread in self.__threads:
+            thread.join()
+        self.__threads = []
+
+# the (row, column, band) axes of an array in each interleave
+_INTERLEAVE_AXES = {Interleave.BSQ: (1, 2, 0),
+                    Interleave.BIP: (0, 1, 2),
+                    Interleave.BIL: (0, 2, 1)}
+
+def _cpu_count():
+    try:
+        import multiprocessing
+        return multiprocessing.cpu_count()
+    except (ImportError, NotImplementedError):
+        return 1
+
+class RasterElementStatistics(object):
+    """Statistics of each band of every pixel of a RasterElement, which
+    are calculated natively on multiple threads. NaN values are ignored.
+    The statistics are kept for each strip of strip_rows rows so after
+    part of the raster has been written, update() reads only the strips
+    which contain the written rows.
+
+    Each statistic is a numpy array with one value per band in bands:
+    count, mean, std (the population standard deviation), min and max.
+    If bins is not zero, histogram is a (bands, bins) array of counts and
+    bin_edges is the matching (bands, bins + 1) array. The histograms
+    cover hist_range, a (lower, upper) tuple, or each band's minimum to
+    maximum when the statistics are created. Values outside of the range
+    are not counted so create new statistics if the range changes.
+
+    """
+    #pylint: disable=R0913
+    def __init__(self, raster, bands=None, bins=256, hist_range=None,
+                 strip_rows=None):
+        try:
+            #pylint: disable=W0612, W0621
+            import numpy
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        info = _opticks.raster_info(raster.handle)
+        rows, columns, band_count = info[:3]
+        if bands is None:
+            bands = range(band_count)
+        self.bands = list(bands)
+        if bins < 0:
+            raise ValueError("bins must not be negative")
+        self.bins = bins
+        if hist_range is None:
+            lower, upper = 1.0, 0.0
+        else:
+            lower, upper = float(hist_range[0]), float(hist_range[1])
+            if lower > upper:
+                raise ValueError("hist_range must be (lower, upper)")
+        if strip_rows is None:
+            span = 1
+            if self.bands:
+                span = max(self.bands) - min(self.bands) + 1
+            strip_rows = max(1, RasterElement.TILE_BYTES //
+                                (columns * span * info[5]))
+        self.raster = raster
+        self.__rows = rows
+        self.__engine = _opticks.statistics_engine(raster.handle,
+                                                   self.bands, bins,
+                                                   lower, upper, strip_rows)
+        self.__result = None
+        self.update()
+
+    def update(self, brow=None, erow=None):
+        """Bring the statistics up to date after rows brow to erow of the
+        raster have been written. These default to the first and last
+        rows.
+
+        """
+        if brow is None:
+            brow = 0
+        if erow is None:
+            erow = self.__rows - 1
+        self.__engine.update(brow, erow)
+        self.__result = None
+
+    def __get(self, stat):
+        if self.__result is None:
+            import numpy
+            counts, means, stds, minimums, maximums, histograms, \
+                lowers, uppers = self.__engine.result()
+            result = {"count": numpy.frombuffer(counts, numpy.uint64),
+                      "mean": numpy.frombuffer(means, numpy.float64),
+                      "std": numpy.frombuffer(stds, numpy.float64),
+                      "min": numpy.frombuffer(minimums, numpy.float64),
+                      "max": numpy.frombuffer(maximums, numpy.float64),
+                      "histogram": None, "bin_edges": None}
+            if histograms is not None:
+                result["histogram"] = numpy.frombuffer(
+                    histograms, numpy.uint64).reshape(len(self.bands),
+                                                      self.bins)
+                lowers = numpy.frombuffer(lowers, numpy.float64)
+                uppers = numpy.frombuffer(uppers, numpy.float64)
+                result["bin_edges"] = (lowers[:, numpy.newaxis] +
+                    (uppers - lowers)[:, numpy.newaxis] *
+                    numpy.linspace(0.0, 1.0, self.bins + 1))
+            self.__result = result
+        return self.__result[stat]
+
+    count = property(lambda self: self.__get("count"))
+    mean = property(lambda self: self.__get("mean"))
+    std = property(lambda self: self.__get("std"))
+    min = property(lambda self: self.__get("min"))
+    max = property(lambda self: self.__get("max"))
+    histogram = property(lambda self: self.__get("histogram"))
+    bin_edges = property(lambda self: self.__get("bin_edges"))
+
 class RasterElement(DataElement):
     "A raster element."
+    # default size of the tiles returned by iter_tiles()
+    TILE_BYTES = 4 * 1024 * 1024
     _createDataPointer = \
         _genwrap("createDataPointer", ctypes.c_void_p, DataElement,
                  ctypes.POINTER(DataPointerArgs),
                  ctypes.POINTER(ctypes.c_int))
+    _destroyDataPointer = \
+        _genwrap("destroyDataPointer", None, ctypes.c_void_p, errorCheck=False)
     _createDataAccessor = \
         _genwrap("createDataAccessor", DataAccessor, DataElement,
                  ctypes.POINTER(DataAccessorArgs))
@@ -1771,7 +2067,6 @@ class RasterElement(DataElement):
         else:
             handle = self._getDataElement(name, "RasterElement", int(0)).handle
         DataElement.__init__(self, None, wrapper=handle)
-        self.data_info = DataInfo(self)
 
     @classmethod
     def all(cls):
@@ -1893,33 +2188,114 @@ class RasterElement(DataElement):
         elem = tempf(name, args)
         return RasterElement(None, element=elem)
 
+    @classmethod
+    def create_in_place(cls, name, rows, columns, bands,
+                        interleave=Interleave.BIP,
+                        encoding=Encoding.INT4SBYTES,
+                        parent=None,
+                        bad_values=None):
+        """Create a raster element in memory and return (raster, block)
+        where block is a writable RasterBlock directly on the element's
+        memory, shaped like data_array. Filling the block fills the
+        raster, so the data is only held once. Call raster.update() when
+        the block has been filled. The block must not be used once the
+        raster has been destroyed, which block.valid reports.
+
+        """
+        #pylint: disable=R0913, W0612, W0621
+        try:
+            import numpy
+            if _RASTER_BLOCK_TYPE is None:
+                _create_raster_block()
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        relem = cls.create3d_empty(name, rows, columns, bands, interleave,
+                                   encoding, ProcessingLocationPreference.RAM,
+                                   parent, bad_values)
+        dbuffer = _opticks.raster_buffer(relem.handle, 0, rows - 1,
+                                         0, columns - 1, 0, bands - 1,
+                                         _opticks.raster_info(relem.handle)[3])
+        if dbuffer.owns_data:
+            relem.destroy()
+            raise OpticksError("The raster element is not held in memory.")
+        return relem, _RASTER_BLOCK_TYPE._from_buffer(dbuffer)
+
+    @classmethod
+    def create_from_tiles(cls, name, rows, columns, bands, tiles,
+                          interleave=Interleave.BIP,
+                          encoding=Encoding.INT4SBYTES,
+                          location=ProcessingLocationPreference.PREFER_RAM,
+                          parent=None,
+                          bad_values=None):
+        """Create a raster element and fill it from tiles, an iterable of
+        (row, column, array) such as a generator. Each array holds every
+        band of a tile, shaped like data_array or (rows, columns) for a
+        single band, and is written as it is produced so only one tile is
+        held at a time. Arrays of other dtypes are converted as by
+        data_array.write().
+
+        """
+        #pylint: disable=R0913, W0702
+        relem = cls.create3d_empty(name, rows, columns, bands, interleave,
+                                   encoding, location, parent, bad_values)
+        row_axis, column_axis, band_axis = \
+            _INTERLEAVE_AXES[_opticks.raster_info(relem.handle)[3]]
+        try:
+            for row, column, tile in tiles:
+                if tile.ndim == 3:
+                    tile_rows = tile.shape[row_axis]
+                    tile_columns = tile.shape[column_axis]
+                else:
+                    tile_rows, tile_columns = tile.shape[:2]
+                key = [None, None, None]
+                key[row_axis] = slice(row, row + tile_rows - 1)
+                key[column_axis] = slice(column, column + tile_columns - 1)
+                key[band_axis] = slice(None)
+                relem.data_array[tuple(key)] = tile
+        except:
+            relem.destroy()
+            raise
+        relem.update()
+        return relem
+
+    @property
+    def data_info(self):
+        return DataInfo(self)
+
     @property
     def info(self):
         return self.data_info
 
+    @property
+    def _raster_info(self):
+        # (rows, columns, bands, interleave, encoding, encoding_size) as
+        # plain values, which are shared by every wrapper of the element
+        return _cached_property(self, "DataElement", "raster_info",
+                                lambda: _opticks.raster_info(self.handle))
+
     @property
     def rows(self):
-        return self.data_info.rows
+        return self._raster_info[0]
 
     @property
     def columns(self):
-        return self.data_info.columns
+        return self._raster_info[1]
 
     @property
     def bands(self):
-        return self.data_info.bands
+        return self._raster_info[2]
 
     @property
     def interleave(self):
-        return self.data_info.interleave
+        return Interleave(self._raster_info[3])
 
     @property
     def encoding(self):
-        return self.data_info.encoding
+        return Encoding(self._raster_info[4])
 
     @property
     def encoding_size(self):
-        return self.data_info.encoding_size
+        return self._raster_info[5]
 
     def get_data_accessor(self, interleave=None,
                           bband=None, eband=None,
@@ -2069,6 +2445,12 @@ class RasterElement(DataElement):
             erow = brow
         args = DataPointerArgs(brow, erow, bcol, ecol, bband, eband,
                                  interleave)
+        if args.interleave.value != nfo.interleave.value:
+            # convert with the native kernel rather than in the core
+            dbuffer = _opticks.raster_buffer(self.handle, brow, erow,
+                                             bcol, ecol, bband, eband,
+                                             args.interleave.value)
+            return buffer(dbuffer), None
         own, deleter = ctypes.c_int(0), None
         ptr = self._createDataPointer(self, args, ctypes.byref(own))
         func = ctypes.pythonapi.PyBuffer_FromMemory
@@ -2081,9 +2463,7 @@ class RasterElement(DataElement):
                 def __init__(self, ptr):
                     self.__ptr = ptr
                 def __del__(self):
-                    tempf = _genwrap("destroyDataPointer", None,
-                                     ctypes.c_void_p, errorCheck=False)
-                    tempf(self.__ptr)
+                    RasterElement._destroyDataPointer(self.__ptr)
             deleter = DeleterObj(ptr)
         return dbuffer, deleter
 
@@ -2095,6 +2475,242 @@ class RasterElement(DataElement):
     def data_array_f(self):
         return _DataArrayTemp(self, True)
 
+    def iter_tiles(self, tile_shape=None, interleave=None,
+                   bband=None, eband=None):
+        """Iterate over the raster a tile at a time.
+        Yields (row, column, block) where row and column are the
+        origin of the tile and block is a RasterBlock containing every
+        band from bband to eband. tile_shape is (rows, columns) and
+        defaults to tiles of roughly TILE_BYTES bytes. Tiles on the
+        right and bottom edges may be smaller. The next tile is read
+        on a worker thread while the current tile is processed so this
+        is the preferred way to process rasters which are not held in
+        memory.
+
+        """
+        #pylint: disable=R0913, W0612, W0621
+        try:
+            import numpy
+            if _RASTER_BLOCK_TYPE is None:
+                _create_raster_block()
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        rows, columns, bands, native, encoding, encoding_size = \
+            _opticks.raster_info(self.handle)
+        if interleave is None:
+            interleave = native
+        elif isinstance(interleave, Interleave):
+            interleave = interleave.value
+        if bband is None:
+            bband = 0
+        if eband is None:
+            eband = bands - 1
+        if tile_shape is None:
+            tile_columns = min(columns, 512)
+            pixel_bytes = (eband - bband + 1) * encoding_size
+            tile_rows = max(1, self.TILE_BYTES // (tile_columns * pixel_bytes))
+            tile_shape = (min(rows, tile_rows), tile_columns)
+        reader = _opticks.tile_reader(self.handle, tile_shape[0],
+                                      tile_shape[1], interleave, bband, eband)
+        for row, column, dbuffer in reader:
+            yield row, column, _RASTER_BLOCK_TYPE._from_buffer(dbuffer)
+
+    def map_tiles(self, func, out=None, workers=None, tile_shape=None,
+                  interleave=None, bband=None, eband=None,
+                  reduce_func=None, initial=None):
+        """Call func(block) for each tile of the raster on a pool of
+        workers threads, which defaults to one per processor. Tiles are
+        read as by iter_tiles() and numpy and native code release the GIL,
+        so the calls run in parallel.
+        If out is a RasterElement, which may be this raster, each result
+        is written to the same rows and columns of every band of out. A
+        result must have out's dtype and the tile's shape in the tile
+        interleave. Results are written on the calling thread and out is
+        updated once at the end.
+        If reduce_func is specified, returns
+        reduce_func(accumulated, result) over the results in tile order,
+        starting from initial or the first result. Otherwise returns out
+        or, if out is None, a list of (row, column, result).
+
+        """
+        #pylint: disable=R0912, R0913, R0914, R0915
+        try:
+            import numpy
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        if workers is None:
+            workers = _cpu_count()
+        if interleave is None:
+            interleave = _opticks.raster_info(self.handle)[3]
+        elif isinstance(interleave, Interleave):
+            interleave = interleave.value
+        row_axis, column_axis = _INTERLEAVE_AXES[interleave][:2]
+        if out is not None:
+            out_info = _opticks.raster_info(out.handle)
+            out_dtype = Encoding(out_info[4]).to_numpy_type()
+        results = []
+        state = {"accumulated": initial, "first": initial is None,
+                 "written": False}
+
+        def finish(row, column, block, task):
+            result = task.result()
+            if out is not None:
+                result = numpy.ascontiguousarray(result)
+                if str(result.dtype) != out_dtype:
+                    raise ValueError("Result has dtype %s but must have %s"
+                                     % (result.dtype, out_dtype))
+                rows = block.shape[row_axis]
+                columns = block.shape[column_axis]
+                if result.size != rows * columns * out_info[2]:
+                    raise ValueError("Result has %s items, but must have "
+                                     "%s items" % (result.size,
+                                     rows * columns * out_info[2]))
+                args = DataPointerArgs(row, row + rows - 1,
+                                       column, column + columns - 1,
+                                       0, out_info[2] - 1, interleave)
+                RasterElement._copyDataToRasterElement(
+                    out, args, result.ctypes.data_as(ctypes.c_void_p))
+                state["written"] = True
+            if reduce_func is not None:
+                if state["first"]:
+                    state["accumulated"], state["first"] = result, False
+                else:
+                    state["accumulated"] = reduce_func(state["accumulated"],
+                                                       result)
+            elif out is None:
+                results.append((row, column, result))
+
+        # at most two tiles per worker are read ahead of the results
+        pending = collections.deque()
+        pool = _TilePool(workers)
+        try:
+            for row, column, block in self.iter_tiles(tile_shape, interleave,
+                                                      bband, eband):
+                pending.append((row, column, block, pool.submit(func, block)))
+                if len(pending) >= 2 * max(1, workers):
+                    finish(*pending.popleft())
+            while pending:
+                finish(*pending.popleft())
+        finally:
+            pool.close()
+            if state["written"]:
+                out.update()
+        if reduce_func is not None:
+            return state["accumulated"]
+        if out is not None:
+            return out
+        return results
+
+    def to_memmap(self, path, tile_shape=None, interleave=None,
+                  bband=None, eband=None):
+        """Export every band from bband to eband to a raw binary file at
+        path with no header, in interleave which defaults to the raster's
+        interleave. The raster is copied a tile at a time as by
+        iter_tiles() so rasters larger than memory can be exported.
+        Returns a read-only numpy.memmap of the file, shaped like
+        data_array.
+
+        """
+        #pylint: disable=R0913
+        try:
+            import numpy
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        rows, columns, bands, native, encoding = \
+            _opticks.raster_info(self.handle)[:5]
+        if interleave is None:
+            interleave = native
+        elif isinstance(interleave, Interleave):
+            interleave = interleave.value
+        if bband is None:
+            bband = 0
+        if eband is None:
+            eband = bands - 1
+        row_axis, column_axis, band_axis = _INTERLEAVE_AXES[interleave]
+        shape = [0, 0, 0]
+        shape[row_axis] = rows
+        shape[column_axis] = columns
+        shape[band_axis] = eband - bband + 1
+        dtype = Encoding(encoding).to_numpy_type()
+        mmap = numpy.memmap(path, dtype, "w+", shape=tuple(shape))
+        try:
+            for row, column, block in self.iter_tiles(tile_shape, interleave,
+                                                      bband, eband):
+                key = [slice(None), slice(None), slice(None)]
+                key[row_axis] = slice(row, row + block.shape[row_axis])
+                key[column_axis] = slice(column,
+                                         column + block.shape[column_axis])
+                mmap[tuple(key)] = block
+        finally:
+            mmap.flush()
+            del mmap
+        return numpy.memmap(path, dtype, "r", shape=tuple(shape))
+
+    @classmethod
+    def from_memmap(cls, path, shape, dtype, interleave=Interleave.BIP,
+                    name=None, offset=0, tile_rows=None,
+                    location=ProcessingLocationPreference.PREFER_RAM,
+                    parent=None,
+                    bad_values=None):
+        """Import a raw binary file, such as one written by to_memmap() or
+        numpy.memmap, as a new raster element. shape is the shape of the
+        file in interleave order or (rows, columns) for a single band,
+        dtype is its numpy dtype and offset is the size of any header.
+        name defaults to the file name. The file is mapped and written to
+        the element tile_rows rows at a time as by create_from_tiles(),
+        so files larger than memory can be imported to an element which
+        is on disk.
+
+        """
+        #pylint: disable=R0913, R0914
+        try:
+            import numpy
+        except ImportError:
+            raise NotImplementedError("numpy is not available")
+        import os.path
+        dtype = numpy.dtype(dtype)
+        encoding = Encoding.from_numpy_type(dtype.name)
+        if isinstance(interleave, Interleave):
+            interleave = interleave.value
+        row_axis, column_axis, band_axis = _INTERLEAVE_AXES[interleave]
+        if len(shape) == 2:
+            dims = [1, 1, 1]
+            dims[row_axis], dims[column_axis] = shape
+            shape = dims
+        elif len(shape) != 3:
+            raise ValueError("shape must be 2-d or 3-d")
+        shape = tuple(shape)
+        rows = shape[row_axis]
+        columns = shape[column_axis]
+        bands = shape[band_axis]
+        if name is None:
+            name = os.path.basename(path)
+        if tile_rows is None:
+            tile_rows = max(1, cls.TILE_BYTES //
+                               (columns * bands * dtype.itemsize))
+        mmap = numpy.memmap(path, dtype, "r", offset=offset, shape=shape)
+
+        def tiles():
+            for row in xrange(0, rows, tile_rows):
+                key = [slice(None), slice(None), slice(None)]
+                key[row_axis] = slice(row, min(rows, row + tile_rows))
+                yield row, 0, mmap[tuple(key)]
+        return cls.create_from_tiles(name, rows, columns, bands, tiles(),
+                                     interleave, encoding, location, parent,
+                                     bad_values)
+
+    def statistics(self, bands=None, bins=256, hist_range=None,
+                   strip_rows=None):
+        """Calculate the statistics of each band index in bands, which
+        defaults to every band, as a RasterElementStatistics. The
+        histograms have bins equal width bins, or there are none if bins
+        is zero. Call update() on the result after writing to the raster.
+
+        """
+        #pylint: disable=R0913
+        return RasterElementStatistics(self, bands, bins, hist_range,
+                                       strip_rows)
+
     def set_data_pointer(self, data, brow=None, erow=None,
                          bcol=None, ecol=None,
                          bband=None, eband=None,
@@ -2349,11 +2965,13 @@ class Layer(ctypes.Structure):
 
     @property
     def name(self):
-        return _stringbuffer_wrap(self._getLayerName, self)
+        return _cached_property(self, "Layer", "name",
+            lambda: _stringbuffer_wrap(self._getLayerName, self))
 
     @property
     def type(self):
-        return _stringbuffer_wrap(self._getLayerType, self)
+        return _cached_property(self, "Layer", "type",
+            lambda: _stringbuffer_wrap(self._getLayerType, self))
 
     @property
     def element(self):
@@ -2522,12 +3140,10 @@ class View(ctypes.Structure):
 
     def iter_layers(self):
         def do_iter(view):
-            get_view_layer = _genwrap("getViewLayer", Layer,
-                                      View, ctypes.c_uint32)
             idx = 0
             while True:
                 try:
-                    layer = get_view_layer(view, idx)
+                    layer = view._getViewLayer(view, idx)
                     yield layer.leafclass()
                 except SimpleApiError, err:
                     if err.code == SimpleApiError.SIMPLE_NOT_FOUND:
@@ -2537,6 +3153,8 @@ class View(ctypes.Structure):
                     idx += 1
         return do_iter(self)
 
+View._getViewLayer = \
+    _genwrap("getViewLayer", Layer, View, ctypes.c_uint32)
 View._getViewName = \
     _genwrap("getViewName", ctypes.c_uint32, View, ctypes.c_char_p,
              ctypes.c_uint32)
@@ -3510,11 +4128,8 @@ class Animation(ctypes.Structure):
                 self.__hndl = hndl
                 self.__cb_func = cb_func
             def __del__(self):
-                destroy_attachment = \
-                    _genwrap("destroyAnimationControllerAttachment", None,
-                             Animation, ctypes.c_char_p, ctypes.c_void_p,
-                             errorCheck=False)
-                destroy_attachment(self.__cntrl, self.__name, self.__hndl)
+                self.__cntrl._destroyAnimationControllerAttachment(
+                    self.__cntrl, self.__name, self.__hndl)
                 del self.__cb_func
         return DeleterObj(self, name, hndl, callback_func)
 
@@ -3529,6 +4144,9 @@ class Animation(ctypes.Structure):
 
 Animation._destroyAnimationController = \
     _genwrap("destroyAnimationController", None, Animation, errorCheck=False)
+Animation._destroyAnimationControllerAttachment = \
+    _genwrap("destroyAnimationControllerAttachment", None, Animation,
+             ctypes.c_char_p, ctypes.c_void_p, errorCheck=False)
 Animation._activateAnimationController = \
     _genwrap("activateAnimationController", ctypes.c_int, Animation)
 Animation._getAnimationControllerState = \
@@ -35,6 +35,89 @@ class ErrorsTestCase(unittest.TestCase):
         self.assertEqual(opticks.SimpleApiError._get_last_error(),
                          opticks.SimpleApiError.SIMPLE_WRONG_TYPE)
 
+    def test_error_check(self):
+        opticks.SimpleApiError._set_last_error(
+            opticks.SimpleApiError.SIMPLE_NOT_FOUND)
+        try:
+            opticks._simple_error_check(42, None, ())
+            self.fail("SimpleApiError not raised")
+        except opticks.SimpleApiError, err:
+            self.failUnlessEqual(err.code,
+                                 opticks.SimpleApiError.SIMPLE_NOT_FOUND)
+            self.failUnlessEqual(err.result, 42)
+        opticks.SimpleApiError._set_last_error(
+            opticks.SimpleApiError.SIMPLE_NO_ERROR)
+        args = (1, 2)
+        self.failUnless(opticks._simple_error_check(None, None, args) is args)
+
+    def test_progress(self):
+        # the tests may or may not be run with a progress object
+        self.failUnless(opticks.progress("Running Python tests", 50)
+                        in (True, False))
+        self.failUnlessRaises(TypeError, opticks.progress, 50)
+
+    def test_output_stream(self):
+        import sys
+        import _opticks
+        self.failUnless(isinstance(sys.stdout, _opticks.OutputStream))
+        self.failIf(sys.stdout.is_error_stream)
+        self.failUnless(sys.stderr.is_error_stream)
+        sys.stdout.write("")
+        sys.stdout.writelines(["", ""])
+        sys.stdout.flush()
+        self.failIf(sys.stdout.isatty())
+        self.failUnlessRaises(TypeError, sys.stdout.write, 1)
+
+    def test_output_stream_threads(self):
+        import sys
+        import threading
+        text = "output from a worker thread\n"
+        sys.stdout.flush()
+        self.assertEqual(sys.stdout.buffered(), 0)
+        worker = threading.Thread(target=sys.stdout.write, args=(text,))
+        worker.start()
+        worker.join()
+        # the worker's text outlives the thread until it is flushed
+        self.failUnless(sys.stdout.buffered() >= len(text))
+        sys.stdout.flush()
+        self.assertEqual(sys.stdout.buffered(), 0)
+
+    def test_code_cache_info(self):
+        import _opticks
+        hits, misses, entries, capacity = _opticks.code_cache_info()
+        self.failUnless(hits >= 0 and misses >= 0)
+        self.failUnless(entries <= capacity)
+
+    def test_lazy_module(self):
+        import interpreter
+        proxy = interpreter.LazyModule("opticks")
+        self.failUnless(proxy.Encoding is opticks.Encoding)
+        self.failUnlessEqual(proxy.__name__, "opticks")
+
+    def test_prepare_script(self):
+        import interpreter
+        results = opticks.DynamicObject()
+        globs = {}
+        interpreter.prepare_script(globs, "script.py", None, None,
+                                   results.handle)
+        self.failUnlessEqual(globs["__name__"], "__main__")
+        self.failUnlessEqual(globs["__file__"], "script.py")
+        self.failUnless(globs["inputs"] is None)
+        self.failUnless(globs["outputs"] is None)
+        globs["results"]["answer"] = 42
+        self.failUnlessEqual(results["answer"].value, 42)
+
+    def test_bindings_are_shared(self):
+        first = opticks._genwrap("getDataElementChildCount", ctypes.c_uint32,
+                                 opticks.DataElement)
+        second = opticks._genwrap("getDataElementChildCount", ctypes.c_uint32,
+                                  opticks.DataElement)
+        self.failUnless(first is second)
+        unchecked = opticks._genwrap("getDataElementChildCount",
+                                     ctypes.c_uint32, opticks.DataElement,
+                                     errorCheck=False)
+        self.failIf(first is unchecked)
+
 class AnimationTestCase(unittest.TestCase):
     def setUp(self):
         self.failUnless(load_test_file("ir_bushehr_06jun02_ps.tif"))
@@ -122,6 +205,27 @@ class DataVariantTestCase(unittest.TestCase):
         self._val_test("UInt64", 100000000000)
         self._val_test("float", 1.23)
 
+    def test_native_vector(self):
+        import array
+        import _opticks
+        values = array.array('d', [400.5, 500.25, 600.0])
+        dvar = opticks.DataVariant(values)
+        self.failUnlessEqual(dvar.dv_type, "vector<double>")
+        view = dvar.value
+        self.failUnless(isinstance(view, _opticks.VariantArray))
+        self.failUnlessEqual(list(view), list(values))
+        self.failUnlessEqual(str(buffer(view)), values.tostring())
+        dvar = opticks.DataVariant([1, 2, 3], "vector<unsigned short>")
+        self.failUnlessEqual(list(dvar.value), [1, 2, 3])
+        dvar = opticks.DataVariant(view, "vector<float>")
+        self.failUnlessEqual(list(dvar.value), list(values))
+        view = dvar.value
+        view[1] = 2.5
+        self.failUnlessEqual(list(view), [400.5, 2.5, 600.0])
+        dvar = opticks.DataVariant([-10000000000, 1], "vector<Int64>")
+        self.failUnlessEqual(list(dvar.value), [-10000000000, 1])
+        self.failUnlessEqual(_opticks.native_type_name("Q"), "UInt64")
+
     def test_positive_errors(self):
         self.failUnlessRaises(opticks.SimpleApiError,
                               opticks.DataVariant, "bad value", "int")
@@ -246,6 +350,18 @@ class DynamicObjectTestCase(unittest.TestCase):
         self.dyn_obj['foo'] = 42
         self.failUnlessEqual(self.dyn_obj['foo'].value, 42)
 
+    def test_dynamic_object_dict(self):
+        values = {'a': 1, 'b': 2.5, 'c': 'text', 'd': True,
+                  'e': [1, 2, 3], 'f': [0.5, 1], 'g': ['x', 'y'],
+                  'h': {'i': 4, 'j': {'k': 'deep'}}}
+        self.dyn_obj.update(values)
+        self.failUnlessEqual(self.dyn_obj['h/j/k'].value, 'deep')
+        self.failUnlessEqual(self.dyn_obj.to_dict(),
+                             dict(values, f=[0.5, 1.0]))
+        self.dyn_obj.update({'h': {'i': 5}})
+        self.failUnlessEqual(self.dyn_obj.to_dict()['h'],
+                             {'i': 5, 'j': {'k': 'deep'}})
+
     def test_configuration_settings(self):
         settings = opticks.ConfigurationSettings()
         self.failUnless(settings['FileLocations/ImportPath'].valid)
@@ -365,6 +481,21 @@ class RasterTestCase(unittest.TestCase):
         self.failUnlessEqual(dinfo.encoding_size, 2)
         self.failUnlessEqual(dinfo.bad_values, [0])
 
+    def test_cached_properties(self):
+        other = opticks.RasterElement("ir_bushehr_06jun02_ps.tif")
+        # each DataInfo is a new copy so changing one does not change the cache
+        info = other.data_info
+        self.failIf(info is self.fetch_re.data_info)
+        info.rows = 1
+        self.failUnlessEqual(other.rows, 997)
+        self.failUnlessEqual(self.fetch_re.data_info.rows, 997)
+        self.failUnlessEqual(other.interleave.value, info.interleave.value)
+        self.failUnlessEqual(other.type, "RasterElement")
+        import _opticks
+        name = self.fetch_re.name
+        cache = _opticks.property_cache(other.handle, "DataElement")
+        self.failUnlessEqual(cache["name"], name)
+
     def test_create_raster_element(self):
         interleave = opticks.Interleave.BSQ
         encoding = opticks.Encoding.INT1UBYTE
@@ -472,6 +603,17 @@ class RasterTestCase(unittest.TestCase):
         self.failUnlessEqual(ushort_ptr[0], 1421)
         del data, deleter
 
+    def test_data_pointer_interleave(self):
+        data, deleter = self.fetch_re.get_data_pointer(
+            erow=9, ecol=19, interleave=opticks.Interleave.BSQ)
+        self.failUnless(deleter is None)
+        self.failUnlessEqual(len(data), 10 * 20 * 3 * 2)
+        bsq = ctypes.cast(ctypes.c_char_p(data[:]),
+                          ctypes.POINTER(ctypes.c_uint16))
+        #check row=0, col=3, band=1 value
+        self.failUnlessEqual(bsq[10 * 20 + 3], 1341)
+        del data, deleter
+
     def test_data_pointer_write(self):
         import array
         temp = array.array('H') #array of shorts
@@ -583,22 +725,61 @@ try:
             self.failUnlessEqual(data.shape, (997, 1000, 3))
             del data
 
+        def test_raster_buffer(self):
+            import _opticks
+            handle = self.fetch_re.handle
+            rows, columns, bands, interleave = _opticks.raster_info(handle)[:4]
+            self.failUnlessEqual((rows, columns, bands), (997, 1000, 3))
+            self.failUnlessEqual(interleave, opticks.Interleave.BIP)
+            buf = _opticks.raster_buffer(handle, 10, 19, 20, 49, 0, 2,
+                                         interleave)
+            self.failUnlessEqual(buf.shape, (10, 30, 3))
+            data = numpy.asarray(buf)
+            full = self.fetch_re.data_array[...]
+            self.failUnless(numpy.array_equal(data, full[10:20, 20:50, :]))
+            del full
+
+            bsq = numpy.asarray(_opticks.raster_buffer(handle, 10, 19, 20, 49,
+                                                       0, 2,
+                                                       opticks.Interleave.BSQ))
+            self.failUnlessEqual(bsq.shape, (3, 10, 30))
+            self.failUnless(bsq.flags.c_contiguous)
+            self.failUnless(numpy.array_equal(bsq, data.transpose(2, 0, 1)))
+            bil = numpy.asarray(_opticks.raster_buffer(handle, 10, 19, 20, 49,
+                                                       1, 2,
+                                                       opticks.Interleave.BIL))
+            self.failUnlessEqual(bil.shape, (10, 2, 30))
+            self.failUnless(numpy.array_equal(bil,
+                                              data[..., 1:].transpose(0, 2, 1)))
+
+            self.failUnlessRaises(IndexError, _opticks.raster_buffer, handle,
+                                  0, rows, 0, 0, 0, 0, interleave)
+            self.failUnlessRaises(IndexError, _opticks.raster_buffer, handle,
+                                  5, 4, 0, 0, 0, 0, interleave)
+            self.failUnlessRaises(ValueError, _opticks.raster_buffer, handle,
+                                  0, 0, 0, 0, 0, 0, 7)
+
+        def test_data_array_convert(self):
+            fake_data = numpy.arange(3000)
+            fake_data.shape = (1, 1000, 3)
+            self.fetch_re.data_array[1] = fake_data
+            self.failUnless(numpy.array_equal(self.fetch_re.data_array[1],
+                                              fake_data))
+
+            # rounded, clamped and scaled as written
+            fake_data = numpy.array([-5.0, 1.5, 2.4, 70000.0, numpy.nan])
+            self.fetch_re.data_array[0, 0:5, 0] = fake_data
+            self.failUnlessEqual(list(self.fetch_re.data_array[0, 0:5, 0].flat),
+                                 [0, 2, 2, 65535, 0])
+            self.fetch_re.data_array.write((0, slice(0, 5), 0), fake_data,
+                                           scale=0.5, offset=10)
+            self.failUnlessEqual(list(self.fetch_re.data_array[0, 0:5, 0].flat),
+                                 [8, 11, 11, 35010, 0])
+            self.failUnlessRaises(TypeError, self.fetch_re.data_array.__setitem__,
+                                  (0, 0, 0), numpy.array([1j]))
+
         def test_data_array_bad_writes(self):
             self.failUnless(self.fetch_re)
-            org_data = self.fetch_re.data_array[1]
-            fake_data = numpy.arange(org_data.size)
-            del org_data
-            try:
-                self.fetch_re.data_array[1] = fake_data
-                self.fail("No exception, but expected ValueError " \
-                          "exception because numpy.ndarray.dtype " \
-                          "is not correct")
-            except ValueError:
-                pass
-            except:
-                self.fail("Expected ValueError exception because " \
-                          "numpy.ndarray.dtype is not correct")
-
             org_data = self.fetch_re.data_array[1]
             fake_data = numpy.arange(1, dtype=org_data.dtype)
             del org_data
@@ -669,6 +850,167 @@ try:
             self.failUnless(numpy.array_equal(expected_data, new_data))
             del new_data
 
+        def test_data_array_steps(self):
+            full = numpy.array(self.fetch_re.data_array[...])
+            data = self.fetch_re.data_array[::8, 1:100:3, ::2]
+            self.failUnlessEqual(data.shape, (125, 34, 2))
+            self.failUnless(numpy.array_equal(data, full[::8, 1:101:3, ::2]))
+            del data
+            data = self.fetch_re.data_array_f[1, ::10, 5:50:5]
+            self.failUnless(numpy.array_equal(data, full[5:51:5, ::10, 1:2]))
+            del data
+            self.failUnlessRaises(IndexError, self.fetch_re.data_array.__getitem__,
+                                  slice(None, None, -1))
+
+            fake_data = numpy.arange(125 * 100, dtype=full.dtype)
+            fake_data.shape = (125, 100, 1)
+            self.fetch_re.data_array[::8, 0:999:10, 2] = fake_data
+            new_data = self.fetch_re.data_array[...]
+            self.failUnless(numpy.array_equal(new_data[::8, ::10, 2:3],
+                                              fake_data))
+            self.failUnless(numpy.array_equal(new_data[1::8], full[1::8]))
+            self.failUnless(numpy.array_equal(new_data[..., :2], full[..., :2]))
+            del new_data
+
+        def test_iter_tiles(self):
+            full = numpy.array(self.fetch_re.data_array[...])
+            covered = numpy.zeros(full.shape[:2], dtype="uint8")
+            for row, column, block in self.fetch_re.iter_tiles((100, 300)):
+                self.failUnless(block.shape[0] <= 100)
+                self.failUnless(block.shape[1] <= 300)
+                rows, columns = block.shape[:2]
+                self.failUnless(numpy.array_equal(
+                    block, full[row:row + rows, column:column + columns]))
+                covered[row:row + rows, column:column + columns] += 1
+            self.failUnless((covered == 1).all())
+
+            count = 0
+            for row, column, block in self.fetch_re.iter_tiles(
+                    (500, 1000), opticks.Interleave.BSQ, 1, 2):
+                self.failUnlessEqual(block.interleave.value,
+                                     opticks.Interleave.BSQ)
+                self.failUnlessEqual(block.shape[0], 2)
+                self.failUnless(numpy.array_equal(block,
+                    full[row:row + block.shape[1], :, 1:].transpose(2, 0, 1)))
+                count += 1
+            self.failUnlessEqual(count, 2)
+
+            # abandoning the iterator stops the worker thread
+            tiles = self.fetch_re.iter_tiles()
+            tiles.next()
+            del tiles
+
+        def test_map_tiles(self):
+            full = numpy.array(self.fetch_re.data_array[...])
+            total = self.fetch_re.map_tiles(
+                lambda block: int(block.sum(dtype="int64")), workers=4,
+                tile_shape=(100, 300), reduce_func=lambda a, b: a + b)
+            self.failUnlessEqual(total, int(full.sum(dtype="int64")))
+
+            tiles = self.fetch_re.map_tiles(lambda block: block.shape,
+                                            tile_shape=(500, 1000))
+            self.failUnlessEqual([(row, column) for row, column, shape in tiles],
+                                 [(0, 0), (500, 0)])
+
+            self.fetch_re.map_tiles(lambda block: block // 2,
+                                    out=self.fetch_re, workers=3,
+                                    tile_shape=(128, 128))
+            self.failUnless(numpy.array_equal(self.fetch_re.data_array[...],
+                                              full // 2))
+
+        def test_create_in_place(self):
+            relem, block = opticks.RasterElement.create_in_place(
+                "in_place", 20, 30, 3, opticks.Interleave.BSQ,
+                opticks.Encoding.INT2UBYTES)
+            self.failUnlessEqual(block.shape, (3, 20, 30))
+            block[...] = numpy.arange(1800, dtype="uint16").reshape(3, 20, 30)
+            relem.update()
+            self.failUnlessEqual(relem.data_array[2, 19, 29], 1799)
+            self.failUnless(block.valid)
+            import _opticks
+            view = _opticks.raster_buffer(relem.handle, 0, 19, 0, 29, 0, 2,
+                                          opticks.Interleave.BSQ)
+            self.failIf(view.owns_data)
+            relem.destroy()
+            self.failIf(block.valid)
+            self.failIf(block[1:].valid)
+            self.failIf(view.valid)
+            self.failUnlessRaises(ValueError, numpy.asarray, view)
+            del block, relem, view
+
+            def tiles():
+                for row in xrange(0, 20, 8):
+                    tile = numpy.empty((min(8, 20 - row), 30, 3), "float64")
+                    tile[...] = row
+                    yield row, 0, tile
+            relem = opticks.RasterElement.create_from_tiles(
+                "from_tiles", 20, 30, 3, tiles(),
+                encoding=opticks.Encoding.INT1UBYTE)
+            self.failUnlessEqual(relem.data_array[...].dtype, numpy.uint8)
+            self.failUnlessEqual(relem.data_array[7, 0, 0], 0)
+            self.failUnlessEqual(relem.data_array[19, 29, 2], 16)
+            tiles = relem.iter_tiles((8, 30))
+            tiles.next()
+            relem.destroy()
+            self.failUnlessRaises(ValueError, tiles.next)
+            del tiles, relem
+
+        def test_memmap(self):
+            import os
+            import tempfile
+            handle, path = tempfile.mkstemp(".raw")
+            os.close(handle)
+            bsq = numpy.array(self.fetch_re.data_array[...]).transpose(2, 0, 1)
+            try:
+                mmap = self.fetch_re.to_memmap(path, tile_shape=(100, 300),
+                                               interleave=opticks.Interleave.BSQ)
+                self.failUnlessEqual(mmap.shape, (3, 1000, 1000))
+                self.failUnless(numpy.array_equal(mmap, bsq))
+                relem = opticks.RasterElement.from_memmap(
+                    path, mmap.shape, mmap.dtype, opticks.Interleave.BSQ,
+                    tile_rows=64)
+                del mmap
+                self.failUnlessEqual(relem.name, os.path.basename(path))
+                self.failUnless(numpy.array_equal(relem.data_array[...], bsq))
+                relem.destroy()
+                del relem
+            finally:
+                os.remove(path)
+
+        def test_statistics(self):
+            data = numpy.arange(6000, dtype="float32").reshape(40, 50, 3)
+            relem = opticks.RasterElement.create3d("stats", data,
+                                                   opticks.Interleave.BIP)
+            stats = relem.statistics(bands=[0, 2], bins=10, strip_rows=8)
+            self.failUnlessEqual(list(stats.count), [2000, 2000])
+            pixels = data.reshape(-1, 3)[:, [0, 2]].astype("float64")
+            self.failUnless(numpy.allclose(stats.mean, pixels.mean(axis=0)))
+            self.failUnless(numpy.allclose(stats.std, pixels.std(axis=0)))
+            self.failUnlessEqual(list(stats.max), [5997, 5999])
+            self.failUnlessEqual(stats.histogram.shape, (2, 10))
+            self.failUnlessEqual(list(stats.histogram.sum(axis=1)), [2000, 2000])
+            self.failUnlessEqual(list(stats.bin_edges[1, [0, -1]]), [2, 5999])
+
+            # only the strip which was written is read again
+            relem.data_array[10:12, ...] = numpy.zeros((3, 50, 3), "float32")
+            relem.data_array[5, 0, 0] = numpy.array([numpy.nan], "float32")
+            stats.update(5, 12)
+            data[10:13] = 0
+            self.failUnlessEqual(list(stats.count), [1999, 2000])
+            self.failUnlessEqual(list(stats.min), [0, 0])
+            self.failUnlessAlmostEqual(stats.mean[1],
+                                       data[..., 2].astype("float64").mean())
+
+            fixed = relem.statistics(bins=4, hist_range=(0, 100))
+            self.failUnlessEqual(list(fixed.bin_edges[0]), [0, 25, 50, 75, 100])
+            self.failUnless(relem.statistics(bins=0).histogram is None)
+            self.failUnlessRaises(IndexError, stats.update, -1, 5)
+            self.failUnlessRaises(IndexError, stats.update, 0, 40)
+            relem.destroy()
+            self.failUnlessRaises(ValueError, stats.update)
+            self.failUnlessEqual(list(stats.count), [1999, 2000])
+            del relem
+
         def test_create_raster2d(self):
             temp = numpy.arange(10, dtype="uint16")
             temp.shape = (5, 2)
@@ -743,6 +1085,91 @@ try:
             relem.destroy()
             del relem
 
+    class AoiNumpyTestCase(unittest.TestCase):
+        def setUp(self):
+            self.failUnless(load_test_file("ir_bushehr_06jun02_ps.tif", True))
+            self.data_el = opticks.DataElement("ir_bushehr_06jun02_ps.tif")
+            self.aoi = opticks.Aoi.create("ir_bushehr_06jun02_ps.tif|mask aoi")
+
+        def tearDown(self):
+            self.data_el.destroy()
+            self.data_el = None
+
+        def test_to_mask(self):
+            self.aoi[10, 15] = True
+            self.aoi[12, 15] = True
+            self.aoi[12, 20] = True
+            mask = self.aoi.to_mask()
+            self.failUnlessEqual(mask.dtype, numpy.bool_)
+            self.failUnlessEqual(mask.shape, (6, 3))
+            self.failUnlessEqual(mask.sum(), 3)
+            self.failUnless(mask[0, 0] and mask[0, 2] and mask[5, 2])
+            mask = self.aoi.to_mask((8, 15, 17, 16))
+            self.failUnlessEqual(mask.shape, (2, 10))
+            self.failUnlessEqual(list(numpy.nonzero(mask[0])[0]), [2, 4])
+            packed = self.aoi.to_mask((8, 15, 17, 16), packed=True)
+            self.failUnlessEqual(packed.dtype, numpy.uint8)
+            self.failUnlessEqual(packed.shape, (2, 2))
+            self.failUnless(numpy.array_equal(packed, numpy.packbits(mask,
+                                                                     axis=1)))
+
+        def test_set_mask(self):
+            mask = numpy.zeros((50, 40), dtype=numpy.bool_)
+            mask[::2, 5:30] = True
+            self.aoi.set_mask(mask, (100, 200))
+            self.failUnless(self.aoi[105, 200])
+            self.failIf(self.aoi[105, 201])
+            self.failIf(self.aoi[104, 200])
+            self.failUnlessEqual(self.aoi.minimal_bounding_box,
+                                 (105, 200, 129, 248))
+            self.failUnless(numpy.array_equal(
+                self.aoi.to_mask((100, 200, 139, 249)), mask))
+
+            # clear pixels in the mask are deselected
+            self.aoi.set_mask(numpy.zeros((1, 10), dtype=numpy.bool_),
+                              (100, 200))
+            self.failIf(self.aoi[105, 200])
+            self.failUnless(self.aoi[110, 200])
+
+            packed = numpy.packbits(mask, axis=1)
+            self.aoi.set_mask(packed, (300, 10), columns=40, packed=True)
+            self.failUnless(numpy.array_equal(
+                self.aoi.to_mask((300, 10, 339, 59)), mask))
+
+            # a uint8 mask is only packed when asked
+            self.aoi.set_mask(numpy.ones((1, 3), dtype=numpy.uint8), (400, 5))
+            self.failUnless(numpy.array_equal(
+                self.aoi.to_mask((400, 5, 407, 5)),
+                [[True, True, True, False, False, False, False, False]]))
+
+        def test_reduce(self):
+            raster = opticks.RasterElement("ir_bushehr_06jun02_ps.tif")
+            mask = numpy.zeros((80, 60), dtype=numpy.bool_)
+            mask[5:70:3, 10:55] = True
+            self.aoi.set_mask(mask, (200, 100))
+            pixels = raster.data_array[100:179, 200:259, :][mask]
+            stats = self.aoi.reduce(raster, bins=16)
+            self.failUnlessEqual(sorted(stats.keys()), sorted(
+                ["mean", "std", "min", "max", "count", "hist"]))
+            for band in range(3):
+                values = pixels[:, band].astype(numpy.float64)
+                self.failUnlessEqual(stats["count"][band], len(values))
+                self.failUnlessAlmostEqual(stats["mean"][band], values.mean(), 6)
+                self.failUnlessAlmostEqual(stats["std"][band], values.std(), 6)
+                self.failUnlessEqual(stats["min"][band], values.min())
+                self.failUnlessEqual(stats["max"][band], values.max())
+                counts, lower, upper = stats["hist"][band]
+                expected = numpy.histogram(values, 16, (lower, upper))[0]
+                self.failUnlessEqual(list(counts), list(expected))
+
+            stats = self.aoi.reduce(raster, ("mean",), bands=[2])
+            self.failUnlessEqual(stats.keys(), ["mean"])
+            self.failUnlessEqual(len(stats["mean"]), 1)
+            self.failUnlessAlmostEqual(stats["mean"][0],
+                                       pixels[:, 2].astype(numpy.float64).mean(), 6)
+            self.failUnlessRaises(ValueError, self.aoi.reduce, raster, ("median",))
+            self.failUnlessRaises(IndexError, self.aoi.reduce, raster, bands=[3])
+
 except ImportError:
     class RasterNumpyTestCase(unittest.TestCase):
         #pylint: disable=R0201